@@ -36,7 +36,16 @@ SOURCES += \
     $$PWD/src/color_utils.cpp \
     $$PWD/src/color_2d_slider.cpp \
     $$PWD/src/color_line_edit.cpp \
-    $$PWD/src/color_names.cpp
+    $$PWD/src/color_names.cpp \
+    $$PWD/src/color_quantization.cpp \
+    $$PWD/src/nearest_color.cpp \
+    $$PWD/src/color_difference.cpp \
+    $$PWD/src/cached_color.cpp \
+    $$PWD/src/emission_throttle.cpp \
+    $$PWD/src/hue_ring.cpp \
+    $$PWD/src/gradient_kernel.cpp \
+    $$PWD/src/color_map.cpp \
+    $$PWD/src/color_list_view.cpp
 
 HEADERS += \
     $$PWD/include/color_wheel.hpp \
@@ -57,7 +66,16 @@ HEADERS += \
     $$PWD/src/color_utils.hpp \
     $$PWD/include/color_2d_slider.hpp \
     $$PWD/include/color_line_edit.hpp \
-    $$PWD/include/color_names.hpp
+    $$PWD/include/color_names.hpp \
+    $$PWD/include/color_difference.hpp \
+    $$PWD/include/cached_color.hpp \
+    $$PWD/include/color_map.hpp \
+    $$PWD/include/color_list_view.hpp \
+    $$PWD/src/color_quantization.hpp \
+    $$PWD/src/nearest_color.hpp \
+    $$PWD/src/emission_throttle.hpp \
+    $$PWD/src/hue_ring.hpp \
+    $$PWD/src/gradient_kernel.hpp
 
 FORMS += \
     $$PWD/src/color_dialog.ui \
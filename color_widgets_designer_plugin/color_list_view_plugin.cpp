@@ -0,0 +1,88 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "color_list_view_plugin.hpp"
+#include "color_list_view.hpp"
+
+QWidget* ColorListView_Plugin::createWidget(QWidget *parent)
+{
+    color_widgets::ColorListView *widget = new color_widgets::ColorListView(parent);
+    return widget;
+}
+
+QIcon ColorListView_Plugin::icon() const
+{
+    return QIcon::fromTheme("format-stroke-color");
+}
+
+QString ColorListView_Plugin::domXml() const
+{
+    return "<ui language=\"c++\">\n"
+           " <widget class=\"color_widgets::ColorListView\" name=\"color_list_view\">\n"
+           " </widget>\n"
+           "</ui>\n";
+}
+
+bool ColorListView_Plugin::isContainer() const
+{
+    return false;
+}
+
+ColorListView_Plugin::ColorListView_Plugin(QObject *parent) :
+    QObject(parent), initialized(false)
+{
+}
+
+void ColorListView_Plugin::initialize(QDesignerFormEditorInterface *)
+{
+    initialized = true;
+}
+
+bool ColorListView_Plugin::isInitialized() const
+{
+    return initialized;
+}
+
+QString ColorListView_Plugin::name() const
+{
+    return "color_widgets::ColorListView";
+}
+
+QString ColorListView_Plugin::group() const
+{
+    return "Color Widgets";
+}
+
+QString ColorListView_Plugin::toolTip() const
+{
+    return "An editable list of colors, suited to long lists";
+}
+
+QString ColorListView_Plugin::whatsThis() const
+{
+    return toolTip();
+}
+
+QString ColorListView_Plugin::includeFile() const
+{
+    return "color_list_view.hpp";
+}
+
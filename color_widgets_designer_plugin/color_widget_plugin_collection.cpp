@@ -30,6 +30,7 @@
 #include "color_palette_widget_plugin.hpp"
 #include "color_2d_slider_plugin.hpp"
 #include "color_line_edit_plugin.hpp"
+#include "color_list_view_plugin.hpp"
 // add new plugin headers above this line
 
 ColorWidgets_PluginCollection::ColorWidgets_PluginCollection(QObject *parent) :
@@ -45,6 +46,7 @@ ColorWidgets_PluginCollection::ColorWidgets_PluginCollection(QObject *parent) :
     widgets.push_back(new ColorPaletteWidget_Plugin(this));
     widgets.push_back(new Color2DSlider_Plugin(this));
     widgets.push_back(new ColorLineEdit_Plugin(this));
+    widgets.push_back(new ColorListView_Plugin(this));
     // add new plugins above this line
 }
 
@@ -74,6 +74,11 @@ protected:
      */
     void appendWidget(QWidget* w);
 
+    /**
+     *  \brief Create a row for each of the given widgets, in a single table update
+     */
+    void appendWidgets(const QList<QWidget*>& widgets);
+
     /**
      *  \brief get the widget found at the given row
      */
@@ -93,6 +98,11 @@ protected:
      */
     void clear();
 
+    /**
+     *  \brief Remove all the rows after the first \p rows without emitting signals
+     */
+    void truncate(int rows);
+
 private Q_SLOTS:
     void remove_clicked(QWidget* w);
     void up_clicked(QWidget* w);
@@ -0,0 +1,117 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_CACHED_COLOR_HPP
+#define COLOR_WIDGETS_CACHED_COLOR_HPP
+
+#include <QColor>
+#include <QString>
+#include "colorwidgets_global.hpp"
+
+namespace color_widgets {
+
+/**
+ * \brief A color which caches its conversions to other color spaces
+ *
+ * Each representation is computed the first time it's requested and kept
+ * until the color changes, so widgets can share a single CachedColor
+ * instead of converting the same QColor over and over.
+ *
+ * HSL and LCH components use the same formulas as ColorWheel, the hue of
+ * all the cylindrical spaces is the HSV hue.
+ */
+class QCP_EXPORT CachedColor
+{
+public:
+    CachedColor();
+    CachedColor(const QColor& color);
+
+    /**
+     * \brief The color as it has been set
+     */
+    const QColor& color() const { return current; }
+
+    /**
+     * \brief Changes the color, discarding all the cached representations
+     */
+    void setColor(const QColor& color);
+
+    /**
+     * \brief The color in the RGB spec
+     */
+    const QColor& rgb() const;
+    int red() const { return rgb().red(); }
+    int green() const { return rgb().green(); }
+    int blue() const { return rgb().blue(); }
+    int alpha() const { return current.alpha(); }
+
+    /// HSV hue in [0-1], -1 for achromatic colors
+    qreal hsvHueF() const;
+    /// HSV saturation in [0-1]
+    qreal hsvSaturationF() const;
+    /// HSV value in [0-1]
+    qreal valueF() const;
+
+    /// HSL saturation in [0-1]
+    qreal hslSaturationF() const;
+    /// HSL lightness in [0-1]
+    qreal lightnessF() const;
+
+    /// LCH chroma in [0-1]
+    qreal chromaF() const;
+    /// LCH luma in [0-1]
+    qreal lumaF() const;
+
+    /**
+     * \brief Hex string as returned by stringFromColor()
+     */
+    const QString& name() const;
+
+    bool operator==(const CachedColor& other) const { return current == other.current; }
+    bool operator!=(const CachedColor& other) const { return current != other.current; }
+
+private:
+    /// Representations that have been computed for the current color
+    enum Cache
+    {
+        CachedRgb  = 0x01,
+        CachedHsv  = 0x02,
+        CachedHsl  = 0x04,
+        CachedLch  = 0x08,
+        CachedName = 0x10
+    };
+
+    void cache_hsv() const;
+    void cache_hsl() const;
+    void cache_lch() const;
+
+    QColor current;
+    mutable int cached;
+    mutable QColor rgb_color;
+    mutable qreal hsv[3];
+    mutable qreal hsl[2];
+    mutable qreal lch[2];
+    mutable QString hex;
+};
+
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_CACHED_COLOR_HPP
@@ -23,6 +23,7 @@
 #define COLOR_WIDGETS_COLOR_2D_SLIDER_HPP
 
 #include "colorwidgets_global.hpp"
+#include "cached_color.hpp"
 #include <QWidget>
 
 namespace color_widgets {
@@ -46,6 +47,22 @@ class QCP_EXPORT Color2DSlider : public QWidget
      * \brief Which color component is used on the y axis
      */
     Q_PROPERTY(Component componentY READ componentY WRITE setComponentY NOTIFY componentYChanged)
+    /**
+     * \brief How often colorChanged() is emitted while dragging
+     *
+     * The last color of a drag is always emitted when the mouse is released.
+     */
+    Q_PROPERTY(EmissionPolicy emissionPolicy READ emissionPolicy WRITE setEmissionPolicy NOTIFY emissionPolicyChanged)
+    /**
+     * \brief Maximum number of emissions per second with EmitRateLimited
+     */
+    Q_PROPERTY(int emissionRate READ emissionRate WRITE setEmissionRate NOTIFY emissionRateChanged)
+    /**
+     * \brief Milliseconds after the last resize before rendering at the new size
+     *
+     * Until then the previous rendering is scaled, 0 renders on every resize.
+     */
+    Q_PROPERTY(int resizeDelay READ resizeDelay WRITE setResizeDelay NOTIFY resizeDelayChanged)
 
 
 public:
@@ -54,12 +71,26 @@ public:
     };
     Q_ENUMS(Component)
 
+    /**
+     * \brief Emission policies for the color signals while dragging
+     */
+    enum EmissionPolicy
+    {
+        EmitImmediately,    ///< Emit on every mouse event
+        EmitPerFrame,       ///< Emit at most once per screen refresh
+        EmitRateLimited     ///< Emit at most emissionRate times per second
+    };
+    Q_ENUMS(EmissionPolicy)
+
     explicit Color2DSlider(QWidget *parent = nullptr);
     ~Color2DSlider();
 
     /// Get current color
     QColor color() const;
 
+    /// Get current color along with its cached conversions
+    const CachedColor& cachedColor() const;
+
     QSize sizeHint() const Q_DECL_OVERRIDE;
 
     /// Get current hue in the range [0-1]
@@ -74,6 +105,10 @@ public:
     Component componentX() const;
     Component componentY() const;
 
+    EmissionPolicy emissionPolicy() const;
+    int emissionRate() const;
+    int resizeDelay() const;
+
 public Q_SLOTS:
 
     /// Set current color
@@ -97,6 +132,10 @@ public Q_SLOTS:
     void setComponentX(Component componentX);
     void setComponentY(Component componentY);
 
+    void setEmissionPolicy(EmissionPolicy policy);
+    void setEmissionRate(int rate);
+    void setResizeDelay(int msec);
+
 Q_SIGNALS:
     /**
      * Emitted when the user selects a color or setColor is called
@@ -110,6 +149,9 @@ Q_SIGNALS:
 
     void componentXChanged(Component componentX);
     void componentYChanged(Component componentY);
+    void emissionPolicyChanged(EmissionPolicy policy);
+    void emissionRateChanged(int rate);
+    void resizeDelayChanged(int msec);
 
 protected:
     void paintEvent(QPaintEvent* event) Q_DECL_OVERRIDE;
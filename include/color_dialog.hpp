@@ -121,8 +121,10 @@ Q_SIGNALS:
     void alphaEnabledChanged(bool alphaEnabled);
 
 private Q_SLOTS:
-    /// Update all the Ui elements to match the selected color
+    /// Schedule an update of the Ui elements to match the selected color
     void update_widgets();
+    /// Perform the update scheduled by update_widgets()
+    void flush_update();
     /// Update from HSV sliders
     void set_hsv();
     /// Update from RGB sliders
@@ -135,6 +137,11 @@ private Q_SLOTS:
 
 private:
     void setColorInternal(const QColor &color);
+    /**
+     * \brief Updates the Ui elements depending on the channels that changed
+     * \param all Whether to update every element regardless of changes
+     */
+    void sync_widgets(bool all);
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event);
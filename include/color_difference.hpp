@@ -0,0 +1,114 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_COLOR_DIFFERENCE_HPP
+#define COLOR_WIDGETS_COLOR_DIFFERENCE_HPP
+
+#include <limits>
+#include <QColor>
+#include <QVector>
+#include "colorwidgets_global.hpp"
+
+namespace color_widgets {
+
+class ColorPalette;
+
+/**
+ * \brief Formula used to measure how different two colors look
+ *
+ * Alpha is always ignored.
+ */
+enum ColorDifference
+{
+    DeltaE76,   ///< Euclidean distance in CIE L*a*b*
+    DeltaE2000, ///< CIEDE2000, corrects CIE L*a*b* non-uniformities
+    DeltaEOklab ///< Euclidean distance in OKLab, L in [0-1]
+};
+
+/**
+ * \brief Euclidean distance in CIE L*a*b*, about 2.3 is a just noticeable difference
+ */
+QCP_EXPORT qreal deltaE76(const QColor& a, const QColor& b);
+
+/**
+ * \brief CIEDE2000 color difference, with unit weighting factors
+ */
+QCP_EXPORT qreal deltaE2000(const QColor& a, const QColor& b);
+
+/**
+ * \brief Euclidean distance in OKLab
+ */
+QCP_EXPORT qreal deltaEOklab(const QColor& a, const QColor& b);
+
+/**
+ * \brief Difference between two colors
+ */
+QCP_EXPORT qreal colorDifference(const QColor& a, const QColor& b, ColorDifference metric);
+
+/**
+ * \brief Difference between each \p a[i] and \p b[i]
+ *
+ * Colors are converted once and the pairs are processed in parallel.
+ * \returns One value per pair, the extra colors of the longer list are ignored
+ */
+QCP_EXPORT QVector<float> colorDifferences(const QVector<QColor>& a,
+                                           const QVector<QColor>& b,
+                                           ColorDifference metric);
+
+/**
+ * \brief Maximum number of values returned by colorDifferenceMatrix()
+ *
+ * The largest float QVector Qt can allocate, a bit over 23000 colors.
+ */
+const qint64 max_difference_matrix_size = (std::numeric_limits<int>::max() - 64) / sizeof(float);
+
+/**
+ * \brief Symmetric matrix of the differences between all pairs of \p colors
+ *
+ * Rows are computed in parallel.
+ * \returns \c colors.size() squared values, the difference between
+ *          \c colors[i] and \c colors[j] is at <tt>i * colors.size() + j</tt>.
+ *          Empty if there would be more than max_difference_matrix_size values.
+ */
+QCP_EXPORT QVector<float> colorDifferenceMatrix(const QVector<QColor>& colors,
+                                                ColorDifference metric);
+
+/**
+ * \brief Finds colors within \p threshold of an earlier color
+ *
+ * Colors are scanned in order, each is either kept or marked as a duplicate
+ * of the first earlier kept color within \p threshold.
+ * Candidates are looked up through a spatial grid in parallel.
+ *
+ * \returns For each color, -1 if it is kept or the index of the kept color it duplicates
+ */
+QCP_EXPORT QVector<int> findSimilarColors(const QVector<QColor>& colors,
+                                          qreal threshold,
+                                          ColorDifference metric);
+
+/**
+ * \brief Difference matrix of the colors in a palette
+ */
+QCP_EXPORT QVector<float> colorDifferenceMatrix(const ColorPalette& palette,
+                                                ColorDifference metric);
+
+} // namespace color_widgets
+#endif // COLOR_WIDGETS_COLOR_DIFFERENCE_HPP
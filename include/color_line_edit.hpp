@@ -88,6 +88,7 @@ protected:
     void dragEnterEvent(QDragEnterEvent *event) Q_DECL_OVERRIDE;
     void dropEvent(QDropEvent * event) Q_DECL_OVERRIDE;
     void paintEvent(QPaintEvent* event) Q_DECL_OVERRIDE;
+    bool event(QEvent* event) Q_DECL_OVERRIDE;
 
 private:
     class Private;
@@ -0,0 +1,96 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_COLOR_LIST_VIEW_HPP
+#define COLOR_WIDGETS_COLOR_LIST_VIEW_HPP
+
+#include <QWidget>
+#include "colorwidgets_global.hpp"
+#include "color_wheel.hpp"
+
+namespace color_widgets {
+
+/**
+ * \brief Editable list of colors, for lists too long for ColorListWidget
+ *
+ * Rows are painted by an item delegate instead of having their own widgets,
+ * so only the visible rows are drawn. Clicking on a color opens a ColorDialog
+ * shared by all the rows, which updates the color as it's being modified.
+ */
+class QCP_EXPORT ColorListView : public QWidget
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QList<QColor> colors READ colors WRITE setColors NOTIFY colorsChanged )
+    Q_PROPERTY(ColorWheel::DisplayFlags wheelFlags READ wheelFlags WRITE setWheelFlags NOTIFY wheelFlagsChanged)
+
+public:
+    explicit ColorListView(QWidget *parent = 0);
+    ~ColorListView();
+
+    QList<QColor> colors() const;
+    void setColors(const QList<QColor>& colors);
+
+    /**
+     * \brief Number of colors
+     */
+    int count() const;
+
+    /// Whether the given row index is valid
+    bool isValidRow(int i) const { return i >= 0 && i < count(); }
+
+    /**
+     * \brief Swap row a and row b
+     */
+    void swap(int a, int b);
+
+    ColorWheel::DisplayFlags wheelFlags() const;
+
+Q_SIGNALS:
+    void colorsChanged(const QList<QColor>&);
+    void wheelFlagsChanged(ColorWheel::DisplayFlags flags);
+
+public Q_SLOTS:
+    /**
+     * \brief Append a black color
+     */
+    void append();
+
+    /**
+     * \brief Remove row i
+     */
+    void remove(int i);
+
+    /**
+     * \brief Show the dialog to edit the color at row i
+     */
+    void editColor(int i);
+
+    void setWheelFlags(ColorWheel::DisplayFlags flags);
+
+private:
+    class Private;
+    Private * const p;
+};
+
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_COLOR_LIST_VIEW_HPP
@@ -62,7 +62,8 @@ private Q_SLOTS:
 private:
     class Private;
     Private * const p;
-    void  append_widget(int col);
+    /// Create the selector for the color at index col
+    QWidget* create_widget(int col);
 };
 
 } // namespace color_widgets
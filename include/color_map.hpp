@@ -0,0 +1,127 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_COLOR_MAP_HPP
+#define COLOR_WIDGETS_COLOR_MAP_HPP
+
+#include <QColor>
+#include <QImage>
+#include <QVector>
+#include "colorwidgets_global.hpp"
+#include "gradient_slider.hpp"
+
+namespace color_widgets {
+
+/**
+ * \brief Maps scalar values to colors using a gradient
+ *
+ * The gradient is sampled once into a lookup table, mapping a value is then
+ * a table lookup. Values are scaled from [minimum(), maximum()] to the table
+ * and clamped, the range defaults to [0, 1].
+ *
+ * Mapping doesn't change the object so large arrays can be processed in
+ * chunks (or from several threads) with the same ColorMap.
+ */
+class QCP_EXPORT ColorMap
+{
+public:
+    /**
+     * \brief Creates an empty map, all values become transparent
+     */
+    ColorMap();
+
+    /**
+     * \param stops         Gradient stops, positions are in [0-1]
+     * \param interpolation Color space used to blend the stops
+     * \param size          Number of entries in the lookup table
+     */
+    explicit ColorMap(const QGradientStops& stops,
+                      GradientSlider::Interpolation interpolation = GradientSlider::InterpolateRgb,
+                      int size = 1024);
+
+    /**
+     * \brief Uses the stops and interpolation of \p slider
+     */
+    explicit ColorMap(const GradientSlider& slider, int size = 1024);
+
+    bool isEmpty() const { return lut.isEmpty(); }
+
+    /**
+     * \brief Number of entries in the lookup table
+     */
+    int size() const { return lut.size(); }
+
+    /**
+     * \brief The lookup table, non-premultiplied ARGB
+     */
+    const QVector<QRgb>& table() const { return lut; }
+
+    qreal minimum() const { return min; }
+    qreal maximum() const { return max; }
+
+    /**
+     * \brief Sets the values mapped to the first and last color
+     *
+     * \p maximum can be less than \p minimum to invert the map.
+     * If they are equal, all values map to the first color.
+     */
+    void setRange(qreal minimum, qreal maximum);
+
+    /**
+     * \brief Color used for NaN values
+     */
+    QRgb nanColor() const { return nan_color; }
+    void setNanColor(QRgb color) { nan_color = color; }
+
+    /**
+     * \brief Color for a single value
+     */
+    QRgb map(float value) const;
+
+    /**
+     * \brief Maps \p count values to \p output
+     *
+     * Large arrays are split between threads.
+     */
+    void map(const float* values, QRgb* output, int count) const;
+    void map(const quint16* values, QRgb* output, int count) const;
+    void map(const quint8* values, QRgb* output, int count) const;
+
+    /**
+     * \brief Maps a row-major array of \p size values to a Format_ARGB32 image
+     */
+    QImage mapImage(const float* values, const QSize& size) const;
+
+private:
+    int index(float value) const;
+    /// Table with an entry for each value of an integer type
+    QVector<QRgb> direct_table(int count) const;
+
+    QVector<QRgb> lut;
+    float min = 0;
+    float max = 1;
+    float scale = 0;
+    QRgb nan_color = 0;
+};
+
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_COLOR_MAP_HPP
@@ -24,6 +24,8 @@
 
 #include <QColor>
 #include <QString>
+#include <QVector>
+#include "colorwidgets_global.hpp"
 
 namespace color_widgets {
 
@@ -33,7 +35,7 @@ namespace color_widgets {
  * Supported string formats:
  *  * Short hex strings #f00
  *  * Long hex strings  #ff0000
- *  * Color names       red
+ *  * Color names       red (CSS named colors, case insensitive)
  *  * Function-like     rgb(255,0,0)
  *
  * Additional string formats supported only when \p alpha is true:
@@ -51,5 +53,111 @@ QColor colorFromString(const QString& string, bool alpha = true);
  */
 QString stringFromColor(const QColor& color, bool alpha = true);
 
+/**
+ * \brief Notation used by formatColor()
+ *
+ * HexString and RgbString can be read back by colorFromString(), with alpha
+ * as an integer in [0-255]. HslString follows CSS, with alpha in [0-1],
+ * and can't be read by colorFromString().
+ */
+enum ColorStringFormat
+{
+    HexString,  ///< #ff0000 or #ff000088
+    RgbString,  ///< rgb(255,0,0) or rgba(255,0,0,136)
+    HslString   ///< hsl(0,100%,50%) or hsla(0,100%,50%,0.533)
+};
+
+/**
+ * \brief Maximum number of characters written by formatColor()
+ */
+const int max_color_string_length = 25;
+
+/**
+ * \brief Writes \p color into \p buffer without allocating
+ *
+ * Alpha is written only when \p alpha is true and the color isn't opaque,
+ * with HexString the result matches stringFromColor().
+ * \param buffer Must have room for max_color_string_length characters
+ * \returns The number of characters written
+ */
+QCP_EXPORT int formatColor(const QColor& color, QChar* buffer,
+                           ColorStringFormat format = HexString,
+                           bool alpha = true);
+
+/**
+ * \brief Appends \p color to \p string as formatted by formatColor()
+ */
+QCP_EXPORT void appendColorString(QString& string, const QColor& color,
+                                  ColorStringFormat format = HexString,
+                                  bool alpha = true);
+
+/**
+ * \brief Formats all of \p colors into a single string
+ *
+ * The string is allocated once, colors are separated by \p separator.
+ */
+QCP_EXPORT QString formatColors(const QVector<QColor>& colors,
+                                ColorStringFormat format = HexString,
+                                bool alpha = true,
+                                QChar separator = QLatin1Char('\n'));
+
+/**
+ * \brief Looks up a CSS color name, case insensitive
+ * \returns An invalid color if \p name isn't a known color name
+ */
+QCP_EXPORT QColor colorFromName(const QString& name);
+
+/**
+ * \brief Name of the CSS named color closest to \p color
+ *
+ * Alpha is ignored and distances are measured in OKLab.
+ * \param distance If not null, set to the distance between the colors
+ */
+QCP_EXPORT QString nearestColorName(const QColor& color, qreal* distance = nullptr);
+
+/**
+ * \brief Color literal found by findColors()
+ */
+struct ColorMatch
+{
+    QColor color;
+    int    position;    ///< Index of the first character of the literal
+    int    length;      ///< Number of characters in the literal
+};
+
+/**
+ * \brief Which color literals findColors() looks for
+ *
+ * Hex numbers without \c # are opt-in: dates, IDs and words like
+ * \c facade look the same, so they're only matched by HexColorText and
+ * AnyColorText. The default CssColorText ignores them.
+ */
+enum ColorTextFormat
+{
+    AnyColorText,   ///< All the literals below
+    CssColorText,   ///< #hex, rgb(), rgba() and color names
+    HexColorText    ///< #hex and hex numbers such as ff8800, ff880080 or 0xff8800
+};
+
+/**
+ * \brief Finds all the color literals in a text
+ *
+ * Literals are recognized as in colorFromString() and must not be part of a
+ * longer word. Hex numbers without \c # need 6 or 8 digits, with a \c 0x
+ * prefix 8 digits are read as AARRGGBB like QRgb.
+ *
+ * \param alpha Whether to recognize literals with an alpha component
+ */
+QCP_EXPORT QVector<ColorMatch> findColors(const QChar* text, int length,
+                                          ColorTextFormat format = CssColorText,
+                                          bool alpha = true);
+
+/**
+ * \brief Finds all the color literals in a string
+ */
+QCP_EXPORT QVector<ColorMatch> findColors(const QString& text,
+                                          ColorTextFormat format = CssColorText,
+                                          bool alpha = true);
+
 } // namespace color_widgets
 #endif // COLOR_WIDGETS_COLOR_NAMES_HPP
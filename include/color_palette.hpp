@@ -29,6 +29,8 @@
 #include <QPair>
 #include <QPixmap>
 #include "colorwidgets_global.hpp"
+#include "color_difference.hpp"
+#include "color_names.hpp"
 
 namespace color_widgets {
 
@@ -64,6 +66,49 @@ class QCP_EXPORT ColorPalette : public QObject
 public:
     typedef QPair<QColor,QString> value_type;
 
+    /**
+     * \brief Algorithm used to reduce the number of colors in an image
+     */
+    enum QuantizationMethod
+    {
+        MedianCut, ///< Recursively split the color distribution along its widest axis
+        Octree,    ///< Merge the least populated branches of an RGB octree
+        KMeans     ///< Median cut refined with k-means clustering
+    };
+    Q_ENUMS(QuantizationMethod)
+
+    /**
+     * \brief Color space used to compare colors while quantizing
+     */
+    enum QuantizationSpace
+    {
+        QuantizeRgb,    ///< Gamma-encoded sRGB
+        QuantizeOklab   ///< OKLab, perceptually uniform
+    };
+    Q_ENUMS(QuantizationSpace)
+
+    /**
+     * \brief How remapImage() approximates colors missing from the palette
+     */
+    enum Dithering
+    {
+        NoDithering,        ///< Each pixel gets the nearest color
+        OrderedDithering,   ///< 8x8 Bayer threshold matrix
+        DiffuseDithering    ///< Floyd-Steinberg error diffusion
+    };
+    Q_ENUMS(Dithering)
+
+    /**
+     * \brief Ordering used by sort()
+     */
+    enum SortKey
+    {
+        SortByHue,          ///< HSV hue, grays first, ties broken by lightness
+        SortByLuminance,    ///< CIE L* lightness
+        SortPerceptual      ///< Position along a Hilbert curve through OKLab
+    };
+    Q_ENUMS(SortKey)
+
     ColorPalette(const QVector<QColor>& colors, const QString& name = QString(), int columns = 0);
     ColorPalette(const QVector<QPair<QColor,QString> >& colors, const QString& name = QString(), int columns = 0);
     explicit ColorPalette(const QString& name = QString());
@@ -89,12 +134,72 @@ public:
     int count() const;
     int columns();
 
+    /**
+     * \brief Index of the color closest to \p color
+     *
+     * Distances are measured in OKLab and alpha is ignored,
+     * ties resolve to the lowest index.
+     * The lookup structure is built on the first query after the colors change.
+     * \param distance If not null, set to the OKLab distance of the match
+     * \returns -1 if the palette is empty
+     */
+    Q_INVOKABLE int nearestIndex(const QColor& color, qreal* distance = nullptr) const;
+
+    /**
+     * \brief Runs nearestIndex() on each color in \p colors
+     */
+    QVector<int> nearestIndices(const QVector<QColor>& colors) const;
+
+    /**
+     * \brief Converts \p image to use only the colors in the palette
+     *
+     * Alpha is discarded. The result is Format_Indexed8 with the palette as
+     * color table if there are at most 256 colors, Format_RGB32 otherwise.
+     * \returns A null image if the palette is empty
+     */
+    Q_INVOKABLE QImage remapImage(const QImage& image, Dithering dithering = NoDithering) const;
+
+    /**
+     * \brief Reorders the colors, keeping their names
+     *
+     * The sort is stable and emits colorsChanged() once.
+     */
+    Q_INVOKABLE void sort(SortKey key, Qt::SortOrder order = Qt::AscendingOrder);
+
+    /**
+     * \brief Splits the colors into at most \p count groups of similar colors
+     *
+     * Uses k-means in OKLab.
+     * \returns For each color the index of its group, groups are numbered
+     *          from the darkest to the lightest
+     */
+    Q_INVOKABLE QVector<int> cluster(int count) const;
+
+    /**
+     * \brief Reorders the colors so each group from cluster() is contiguous
+     *
+     * The order of colors within a group is preserved.
+     */
+    Q_INVOKABLE void groupClusters(int count);
+
+    /**
+     * \brief Removes colors within \p threshold of an earlier color
+     *
+     * The first color (and name) of each group of similar colors is kept.
+     * \returns The number of colors removed
+     * \see findSimilarColors()
+     */
+    Q_INVOKABLE int mergeSimilar(qreal threshold, ColorDifference metric = DeltaE2000);
+
     QString name() const;
 
     /**
      * \brief Use a color table to set the colors
+     *
+     * Alpha is discarded.
+     * \param unique If \b true, only the first occurrence of each color is kept
      */
-    Q_INVOKABLE void loadColorTable(const QVector<QRgb>& color_table);
+    Q_INVOKABLE void loadColorTable(const QVector<QRgb>& color_table, bool unique = false);
 
     /**
      * \brief Convert to a color table
@@ -104,17 +209,42 @@ public:
     /**
      * \brief Creates a ColorPalette from a color table
      */
-    static ColorPalette fromColorTable(const QVector<QRgb>& table);
+    static ColorPalette fromColorTable(const QVector<QRgb>& table, bool unique = false);
 
     /**
      * \brief Use the pixels on an image to set the palette colors
+     *
+     * Alpha is discarded.
+     * \param unique If \b true, only the first occurrence of each color is
+     *               kept and the number of columns is left unspecified,
+     *               otherwise it matches the image width
+     */
+    Q_INVOKABLE bool loadImage(const QImage& image, bool unique = false);
+
+    /**
+     * \brief Use the most representative colors of an image to set the palette colors
+     *
+     * Colors are sorted by the number of pixels they represent and fully
+     * transparent pixels are ignored.
+     *
+     * \param max_colors Maximum number of colors in the palette
+     * \param space      Color space used to compare colors, ignored by Octree
      */
-    Q_INVOKABLE bool loadImage(const QImage& image);
+    Q_INVOKABLE bool loadImage(const QImage& image, QuantizationMethod method,
+                               int max_colors = 256,
+                               QuantizationSpace space = QuantizeRgb);
 
     /**
      * \brief Creates a ColorPalette from a Gimp palette (gpl) file
      */
-    static ColorPalette fromImage(const QImage& image);
+    static ColorPalette fromImage(const QImage& image, bool unique = false);
+
+    /**
+     * \brief Creates a ColorPalette with the most representative colors of an image
+     */
+    static ColorPalette fromImage(const QImage& image, QuantizationMethod method,
+                                  int max_colors = 256,
+                                  QuantizationSpace space = QuantizeRgb);
 
     /**
      * \brief Load contents from a Gimp palette (gpl) file
@@ -159,6 +289,21 @@ public Q_SLOTS:
      * \brief Append a color at the end
      */
     void appendColor(const QColor& color, const QString& name = QString());
+    /**
+     * \brief Append several colors at the end, emitting colorsChanged() once
+     */
+    void appendColors(const QVector<QColor>& colors);
+    /**
+     * \brief Append all the color literals found in \p text
+     * \returns The number of colors added
+     * \see findColors()
+     */
+    int importText(const QString& text, ColorTextFormat format = CssColorText);
+    /**
+     * \brief Append all the color literals found in a text file
+     * \returns The number of colors added, -1 if the file can't be read
+     */
+    int importFile(const QString& filename, ColorTextFormat format = CssColorText);
     /**
      * \brief Insert a color in an arbitrary location
      */
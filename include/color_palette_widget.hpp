@@ -151,6 +151,11 @@ public Q_SLOTS:
      * \return \b true on success
      */
     bool setCurrentColor(int index);
+    /**
+     * \brief Selects the palette color closest to \p color
+     * \return The selected index, -1 if the palette is empty
+     */
+    int setNearestColor(const QColor& color);
     /**
      * \brief Set the selected row in the model
      */
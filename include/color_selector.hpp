@@ -29,6 +29,8 @@ namespace color_widgets {
 
 /**
  * Color preview that opens a color dialog
+ *
+ * The dialog is created the first time it's shown.
  */
 class QCP_EXPORT ColorSelector : public ColorPreview
 {
@@ -37,6 +39,14 @@ class QCP_EXPORT ColorSelector : public ColorPreview
     Q_PROPERTY(UpdateMode updateMode READ updateMode WRITE setUpdateMode )
     Q_PROPERTY(Qt::WindowModality dialogModality READ dialogModality WRITE setDialogModality )
     Q_PROPERTY(ColorWheel::DisplayFlags wheelFlags READ wheelFlags WRITE setWheelFlags NOTIFY wheelFlagsChanged)
+    /**
+     * \brief Whether to use a dialog shared with the other selectors in the
+     * same window that have this enabled
+     *
+     * Showing the dialog from one of them takes it away from the selector
+     * currently using it, without accepting or rejecting the edit.
+     */
+    Q_PROPERTY(bool sharedDialog READ sharedDialog WRITE setSharedDialog)
 
 public:
     enum UpdateMode {
@@ -55,6 +65,9 @@ public:
 
     ColorWheel::DisplayFlags wheelFlags() const;
 
+    bool sharedDialog() const;
+    void setSharedDialog(bool shared);
+
 Q_SIGNALS:
     void wheelFlagsChanged(ColorWheel::DisplayFlags flags);
 
@@ -66,6 +79,7 @@ private Q_SLOTS:
     void accept_dialog();
     void reject_dialog();
     void update_old_color(const QColor &c);
+    void update_wheel_flags(ColorWheel::DisplayFlags flags);
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event);
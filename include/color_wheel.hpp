@@ -23,6 +23,7 @@
 #define COLOR_WHEEL_HPP
 
 #include "colorwidgets_global.hpp"
+#include "cached_color.hpp"
 
 #include <QWidget>
 
@@ -44,6 +45,34 @@ class QCP_EXPORT ColorWheel : public QWidget
     Q_PROPERTY(qreal value READ value WRITE setValue DESIGNABLE false )
     Q_PROPERTY(unsigned wheelWidth READ wheelWidth WRITE setWheelWidth DESIGNABLE true )
     Q_PROPERTY(DisplayFlags displayFlags READ displayFlags WRITE setDisplayFlags NOTIFY displayFlagsChanged DESIGNABLE true )
+    /**
+     * \brief How often colorChanged() and colorSelected() are emitted while dragging
+     *
+     * The last color of a drag is always emitted when the mouse is released.
+     */
+    Q_PROPERTY(EmissionPolicy emissionPolicy READ emissionPolicy WRITE setEmissionPolicy NOTIFY emissionPolicyChanged)
+    /**
+     * \brief Maximum number of emissions per second with EmitRateLimited
+     */
+    Q_PROPERTY(int emissionRate READ emissionRate WRITE setEmissionRate NOTIFY emissionRateChanged)
+    /**
+     * \brief Milliseconds after the last resize before rendering at the new size
+     *
+     * Until then the previous rendering is scaled, 0 renders on every resize.
+     */
+    Q_PROPERTY(int resizeDelay READ resizeDelay WRITE setResizeDelay NOTIFY resizeDelayChanged)
+    /**
+     * \brief Maximum size in device pixels of the inner selector while the hue changes
+     *
+     * Used during drags and quick successions of hue changes, 0 means no limit.
+     */
+    Q_PROPERTY(int selectorDragResolution READ selectorDragResolution WRITE setSelectorDragResolution NOTIFY selectorDragResolutionChanged)
+    /**
+     * \brief Maximum size in device pixels of the inner selector at rest
+     *
+     * 0 means the selector is rendered at the native resolution.
+     */
+    Q_PROPERTY(int selectorIdleResolution READ selectorIdleResolution WRITE setSelectorIdleResolution NOTIFY selectorIdleResolutionChanged)
 
 public:
     enum DisplayEnum
@@ -70,12 +99,26 @@ public:
     Q_DECLARE_FLAGS(DisplayFlags, DisplayEnum)
     Q_FLAGS(DisplayFlags)
 
+    /**
+     * \brief Emission policies for the color signals while dragging
+     */
+    enum EmissionPolicy
+    {
+        EmitImmediately,    ///< Emit on every mouse event
+        EmitPerFrame,       ///< Emit at most once per screen refresh
+        EmitRateLimited     ///< Emit at most emissionRate times per second
+    };
+    Q_ENUMS(EmissionPolicy)
+
     explicit ColorWheel(QWidget *parent = 0);
     ~ColorWheel();
 
     /// Get current color
     QColor color() const;
 
+    /// Get current color along with its cached conversions
+    const CachedColor& cachedColor() const;
+
     virtual QSize sizeHint() const Q_DECL_OVERRIDE;
 
     /// Get current hue in the range [0-1]
@@ -109,6 +152,13 @@ public:
      */
     void setDisplayFlag(DisplayFlags flag, DisplayFlags mask);
 
+    EmissionPolicy emissionPolicy() const;
+    int emissionRate() const;
+    int resizeDelay() const;
+
+    int selectorDragResolution() const;
+    int selectorIdleResolution() const;
+
 public Q_SLOTS:
 
     /// Set current color
@@ -135,6 +185,13 @@ public Q_SLOTS:
      */
     void setDisplayFlags(ColorWheel::DisplayFlags flags);
 
+    void setEmissionPolicy(EmissionPolicy policy);
+    void setEmissionRate(int rate);
+    void setResizeDelay(int msec);
+
+    void setSelectorDragResolution(int resolution);
+    void setSelectorIdleResolution(int resolution);
+
 Q_SIGNALS:
     /**
      * Emitted when the user selects a color or setColor is called
@@ -147,6 +204,11 @@ Q_SIGNALS:
     void colorSelected(QColor);
 
     void displayFlagsChanged(ColorWheel::DisplayFlags flags);
+    void emissionPolicyChanged(EmissionPolicy policy);
+    void emissionRateChanged(int rate);
+    void resizeDelayChanged(int msec);
+    void selectorDragResolutionChanged(int resolution);
+    void selectorIdleResolutionChanged(int resolution);
 
 protected:
     void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
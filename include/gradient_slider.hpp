@@ -27,6 +27,7 @@
 
 #include <QSlider>
 #include <QGradient>
+#include <QImage>
 
 namespace color_widgets {
 
@@ -41,8 +42,23 @@ class QCP_EXPORT GradientSlider : public QSlider
     Q_PROPERTY(QColor firstColor READ firstColor WRITE setFirstColor STORED false)
     Q_PROPERTY(QColor lastColor READ lastColor WRITE setLastColor STORED false)
     Q_PROPERTY(QLinearGradient gradient READ gradient WRITE setGradient)
+    Q_PROPERTY(Interpolation interpolation READ interpolation WRITE setInterpolation)
 
 public:
+    /**
+     * \brief Color space used to blend the colors between two stops
+     */
+    enum Interpolation
+    {
+        InterpolateRgb,         ///< Gamma-encoded sRGB, like QLinearGradient
+        InterpolateLinearRgb,   ///< Linear light sRGB
+        InterpolateHsvShorter,  ///< HSV, going around the shorter hue arc
+        InterpolateHsvLonger,   ///< HSV, going around the longer hue arc
+        InterpolateOklab,       ///< OKLab, perceptually uniform
+        InterpolateOklch        ///< OKLCh, OKLab with the shorter hue arc
+    };
+    Q_ENUMS(Interpolation)
+
     explicit GradientSlider(QWidget *parent = 0);
     explicit GradientSlider(Qt::Orientation orientation, QWidget *parent = 0);
     ~GradientSlider();
@@ -95,9 +111,37 @@ public:
      * \returns QColor() con empty gradient
      */
     QColor lastColor() const;
-    
+
+    /// Get the color space used to blend the stops
+    Interpolation interpolation() const;
+    /// Set the color space used to blend the stops
+    void setInterpolation(Interpolation interpolation);
+
+    /**
+     * \brief Color of the gradient at \p t, in [0-1] from the first to the last end
+     *
+     * Matches what is displayed, positions outside the stops are clamped.
+     * \returns An invalid color if the gradient is empty
+     */
+    Q_INVOKABLE QColor sample(qreal t) const;
+
 protected:
     void paintEvent(QPaintEvent *ev);
+    void sliderChange(SliderChange change) Q_DECL_OVERRIDE;
+
+    /**
+     * \brief Area of the handle for the current value
+     */
+    QRect handleRect() const;
+
+    /**
+     * \brief Renders the gradient as a single row of \p length pixels
+     *
+     * Pixels are sampled at their centers and the result is Format_ARGB32,
+     * it's stretched to fill the slider (top to bottom if vertical).
+     * Called only when the gradient or the size changes.
+     */
+    virtual QImage renderGradient(int length) const;
 
 private:
     class Private;
@@ -85,6 +85,12 @@ public Q_SLOTS:
 Q_SIGNALS:
     void colorHueChanged(qreal colorHue);
 
+protected:
+    /**
+     * \brief Renders the hues with exact HSV, shared between sliders with the same color
+     */
+    QImage renderGradient(int length) const Q_DECL_OVERRIDE;
+
 private:
     class Private;
     Private * const p;
@@ -88,9 +88,18 @@ void AbstractWidgetList::setRowHeight(int row, int height)
 
 void AbstractWidgetList::clear()
 {
-    p->widgets.clear();
-    while(p->table->rowCount() > 0)
-        p->table->removeRow(0);
+    truncate(0);
+}
+
+void AbstractWidgetList::truncate(int rows)
+{
+    if ( rows < 0 || rows >= count() )
+        return;
+
+    p->widgets.erase(p->widgets.begin() + rows, p->widgets.end());
+    p->table->setRowCount(rows);
+    if ( rows > 0 )
+        p->table->cellWidget(rows-1,2)->setEnabled(false);
 }
 
 
@@ -112,24 +121,44 @@ void AbstractWidgetList::remove(int i)
 
 void AbstractWidgetList::appendWidget(QWidget *w)
 {
-    int row = count();
-    p->table->insertRow(row);
-
-    QWidget* b_up = create_button(w,&p->mapper_up,QStringLiteral("go-up"),tr("Move Up"));
-    QWidget* b_down = create_button(w,&p->mapper_down,QStringLiteral("go-down"),tr("Move Down"));
-    QWidget* b_remove = create_button(w,&p->mapper_remove,QStringLiteral("list-remove"),tr("Remove"));
-    if ( row == 0 )
-        b_up->setEnabled(false);
-    else
-        p->table->cellWidget(row-1,2)->setEnabled(true);
-    b_down->setEnabled(false);
-
-    p->table->setCellWidget(row,0,w);
-    p->table->setCellWidget(row,1,b_up);
-    p->table->setCellWidget(row,2,b_down);
-    p->table->setCellWidget(row,3,b_remove);
-
-    p->widgets.push_back(w);
+    appendWidgets(QList<QWidget*>() << w);
+}
+
+void AbstractWidgetList::appendWidgets(const QList<QWidget*>& widgets)
+{
+    if ( widgets.isEmpty() )
+        return;
+
+    bool updates = p->table->updatesEnabled();
+    p->table->setUpdatesEnabled(false);
+
+    int first = count();
+    p->table->setRowCount(first + widgets.size());
+    if ( first > 0 )
+        p->table->cellWidget(first-1,2)->setEnabled(true);
+
+    for ( int i = 0; i < widgets.size(); i++ )
+    {
+        QWidget* w = widgets[i];
+        int row = first + i;
+
+        QWidget* b_up = create_button(w,&p->mapper_up,QStringLiteral("go-up"),tr("Move Up"));
+        QWidget* b_down = create_button(w,&p->mapper_down,QStringLiteral("go-down"),tr("Move Down"));
+        QWidget* b_remove = create_button(w,&p->mapper_remove,QStringLiteral("list-remove"),tr("Remove"));
+        if ( row == 0 )
+            b_up->setEnabled(false);
+        if ( i == widgets.size() - 1 )
+            b_down->setEnabled(false);
+
+        p->table->setCellWidget(row,0,w);
+        p->table->setCellWidget(row,1,b_up);
+        p->table->setCellWidget(row,2,b_down);
+        p->table->setCellWidget(row,3,b_remove);
+
+        p->widgets.push_back(w);
+    }
+
+    p->table->setUpdatesEnabled(updates);
 }
 
 QWidget *AbstractWidgetList::widget(int i)
@@ -0,0 +1,136 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "cached_color.hpp"
+#include "color_names.hpp"
+#include "color_utils.hpp"
+
+namespace color_widgets {
+
+CachedColor::CachedColor()
+    : cached(0)
+{}
+
+CachedColor::CachedColor(const QColor& color)
+    : current(color), cached(0)
+{}
+
+void CachedColor::setColor(const QColor& color)
+{
+    current = color;
+    cached = 0;
+}
+
+const QColor& CachedColor::rgb() const
+{
+    if ( !(cached & CachedRgb) )
+    {
+        rgb_color = current.toRgb();
+        cached |= CachedRgb;
+    }
+    return rgb_color;
+}
+
+void CachedColor::cache_hsv() const
+{
+    if ( !(cached & CachedHsv) )
+    {
+        QColor converted = current.toHsv();
+        hsv[0] = converted.hsvHueF();
+        hsv[1] = converted.hsvSaturationF();
+        hsv[2] = converted.valueF();
+        cached |= CachedHsv;
+    }
+}
+
+qreal CachedColor::hsvHueF() const
+{
+    cache_hsv();
+    return hsv[0];
+}
+
+qreal CachedColor::hsvSaturationF() const
+{
+    cache_hsv();
+    return hsv[1];
+}
+
+qreal CachedColor::valueF() const
+{
+    cache_hsv();
+    return hsv[2];
+}
+
+void CachedColor::cache_hsl() const
+{
+    if ( !(cached & CachedHsl) )
+    {
+        hsl[0] = detail::color_HSL_saturationF(rgb());
+        hsl[1] = detail::color_lightnessF(rgb());
+        cached |= CachedHsl;
+    }
+}
+
+qreal CachedColor::hslSaturationF() const
+{
+    cache_hsl();
+    return hsl[0];
+}
+
+qreal CachedColor::lightnessF() const
+{
+    cache_hsl();
+    return hsl[1];
+}
+
+void CachedColor::cache_lch() const
+{
+    if ( !(cached & CachedLch) )
+    {
+        lch[0] = detail::color_chromaF(rgb());
+        lch[1] = detail::color_lumaF(rgb());
+        cached |= CachedLch;
+    }
+}
+
+qreal CachedColor::chromaF() const
+{
+    cache_lch();
+    return lch[0];
+}
+
+qreal CachedColor::lumaF() const
+{
+    cache_lch();
+    return lch[1];
+}
+
+const QString& CachedColor::name() const
+{
+    if ( !(cached & CachedName) )
+    {
+        hex = stringFromColor(rgb());
+        cached |= CachedName;
+    }
+    return hex;
+}
+
+} // namespace color_widgets
@@ -21,10 +21,13 @@
  */
 #include "color_2d_slider.hpp"
 #include "color_utils.hpp"
+#include "emission_throttle.hpp"
 #include <QImage>
 #include <QPainter>
 #include <QMouseEvent>
 #include <QResizeEvent>
+#include <QPaintEvent>
+#include <QTimer>
 
 namespace color_widgets {
 
@@ -32,11 +35,57 @@ static const double selector_radius = 6;
 
 class Color2DSlider::Private
 {
+private:
+    Color2DSlider * const w;
+
 public:
     qreal hue = 1, sat = 1, val = 1;
     Component comp_x = Saturation;
     Component comp_y = Value;
     QImage square;
+    /// Color from hue, sat and val, updated by update_color()
+    CachedColor current = QColor::fromHsvF(hue, sat, val);
+
+    EmissionPolicy emission_policy = EmitImmediately;
+    int emission_rate = 30;
+    detail::EmissionThrottle emission;
+    /// Milliseconds after the last resize before rendering at the new size
+    int resize_delay = 100;
+    QTimer resize_timer;
+    /// Whether a resize has been rendered while visible, only later ones are delayed
+    bool resized_visible = false;
+
+    Private(Color2DSlider* widget)
+        : w(widget), emission([this]{ Q_EMIT w->colorChanged(current.color()); })
+    {
+        resize_timer.setSingleShot(true);
+        QObject::connect(&resize_timer, &QTimer::timeout, [this]{
+            renderSquare(w->size());
+            w->update();
+        });
+    }
+
+    /// Must be called after changing hue, sat or val
+    void update_color()
+    {
+        current.setColor(QColor::fromHsvF(hue, sat, val));
+    }
+
+    void update_emission_interval()
+    {
+        switch ( emission_policy )
+        {
+            case EmitImmediately:
+                emission.setInterval(0);
+                break;
+            case EmitPerFrame:
+                emission.setInterval(detail::frame_interval(w));
+                break;
+            case EmitRateLimited:
+                emission.setInterval(1000 / emission_rate);
+                break;
+        }
+    }
 
     qreal PixHue(float x, float y)
     {
@@ -102,6 +151,16 @@ public:
         return pt;
     }
 
+    /// Area covered by the handle
+    QRect selectorRect(const QSize& size)
+    {
+        // Accounts for the pen width and antialiasing
+        qreal radius = selector_radius + 3;
+        QPointF center = selectorPos(size);
+        return QRectF(center.x() - radius, center.y() - radius, radius*2, radius*2)
+            .toAlignedRect();
+    }
+
     void setColorFromPos(const QPoint& pt, const QSize& size)
     {
         QPointF ptfloat(
@@ -120,11 +179,12 @@ public:
             case Saturation:sat = ptfloat.y(); break;
             case Value:     val = ptfloat.y(); break;
         }
+        update_color();
     }
 };
 
 Color2DSlider::Color2DSlider(QWidget* parent)
-    : QWidget(parent), p(new Private)
+    : QWidget(parent), p(new Private(this))
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 }
@@ -136,7 +196,12 @@ Color2DSlider::~Color2DSlider()
 
 QColor Color2DSlider::color() const
 {
-    return QColor::fromHsvF(p->hue, p->sat, p->val);
+    return p->current.color();
+}
+
+const CachedColor& Color2DSlider::cachedColor() const
+{
+    return p->current;
 }
 
 QSize Color2DSlider::sizeHint() const
@@ -171,9 +236,12 @@ Color2DSlider::Component Color2DSlider::componentY() const
 
 void Color2DSlider::setColor(const QColor& c)
 {
-    p->hue = c.hsvHueF();
-    p->sat = c.saturationF();
-    p->val = c.valueF();
+    p->emission.cancel();
+    CachedColor cached(c);
+    p->hue = cached.hsvHueF();
+    p->sat = cached.hsvSaturationF();
+    p->val = cached.valueF();
+    p->update_color();
     p->renderSquare(size());
     update();
     Q_EMIT colorChanged(color());
@@ -181,7 +249,9 @@ void Color2DSlider::setColor(const QColor& c)
 
 void Color2DSlider::setHue(qreal h)
 {
+    p->emission.cancel();
     p->hue = h;
+    p->update_color();
     p->renderSquare(size());
     update();
     Q_EMIT colorChanged(color());
@@ -189,7 +259,9 @@ void Color2DSlider::setHue(qreal h)
 
 void Color2DSlider::setSaturation(qreal s)
 {
+    p->emission.cancel();
     p->sat = s;
+    p->update_color();
     p->renderSquare(size());
     update();
     Q_EMIT colorChanged(color());
@@ -197,7 +269,9 @@ void Color2DSlider::setSaturation(qreal s)
 
 void Color2DSlider::setValue(qreal v)
 {
+    p->emission.cancel();
     p->val = v;
+    p->update_color();
     p->renderSquare(size());
     update();
     Q_EMIT colorChanged(color());
@@ -225,11 +299,20 @@ void Color2DSlider::setComponentY(Color2DSlider::Component componentY)
     }
 }
 
-void Color2DSlider::paintEvent(QPaintEvent*)
+void Color2DSlider::paintEvent(QPaintEvent* event)
 {
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
-    painter.drawImage(0,0,p->square);
+    if ( p->square.size() == size() )
+    {
+        painter.drawImage(event->rect(), p->square, event->rect());
+    }
+    else
+    {
+        // Still resizing, the old square is stretched in the meantime
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(rect(), p->square);
+    }
 
     painter.setPen(QPen(p->val > 0.5 ? Qt::black : Qt::white, 3));
     painter.setBrush(Qt::NoBrush);
@@ -238,30 +321,99 @@ void Color2DSlider::paintEvent(QPaintEvent*)
 
 void Color2DSlider::mousePressEvent(QMouseEvent* event)
 {
+    p->update_emission_interval();
+    QRect dirty = p->selectorRect(size());
     p->setColorFromPos(event->pos(), size());
-    Q_EMIT colorChanged(color());
-    update();
+    p->emission.request();
+    update(QRegion(dirty).united(p->selectorRect(size())));
 }
 
 void Color2DSlider::mouseMoveEvent(QMouseEvent* event)
 {
+    QRect dirty = p->selectorRect(size());
     p->setColorFromPos(event->pos(), size());
-    Q_EMIT colorChanged(color());
-    update();
+    p->emission.request();
+    update(QRegion(dirty).united(p->selectorRect(size())));
 }
 
 void Color2DSlider::mouseReleaseEvent(QMouseEvent* event)
 {
+    QRect dirty = p->selectorRect(size());
     p->setColorFromPos(event->pos(), size());
-    Q_EMIT colorChanged(color());
-    update();
+    p->emission.request();
+    p->emission.flush();
+    update(QRegion(dirty).united(p->selectorRect(size())));
 }
 
 void Color2DSlider::resizeEvent(QResizeEvent* event)
 {
-    p->renderSquare(event->size());
+    // The square may have been rendered at the default size by the setters,
+    // the size from the layout when first shown must not be delayed
+    if ( p->resize_delay > 0 && p->resized_visible )
+    {
+        p->resize_timer.start(p->resize_delay);
+    }
+    else
+    {
+        p->resize_timer.stop();
+        p->renderSquare(event->size());
+        p->resized_visible = isVisible();
+    }
     update();
 }
 
+Color2DSlider::EmissionPolicy Color2DSlider::emissionPolicy() const
+{
+    return p->emission_policy;
+}
+
+void Color2DSlider::setEmissionPolicy(EmissionPolicy policy)
+{
+    if ( policy != p->emission_policy )
+    {
+        p->emission.flush();
+        p->emission_policy = policy;
+        p->update_emission_interval();
+        Q_EMIT emissionPolicyChanged(policy);
+    }
+}
+
+int Color2DSlider::emissionRate() const
+{
+    return p->emission_rate;
+}
+
+void Color2DSlider::setEmissionRate(int rate)
+{
+    rate = qBound(1, rate, 1000);
+    if ( rate != p->emission_rate )
+    {
+        p->emission_rate = rate;
+        p->update_emission_interval();
+        Q_EMIT emissionRateChanged(rate);
+    }
+}
+
+
+int Color2DSlider::resizeDelay() const
+{
+    return p->resize_delay;
+}
+
+void Color2DSlider::setResizeDelay(int msec)
+{
+    msec = qMax(0, msec);
+    if ( msec != p->resize_delay )
+    {
+        p->resize_delay = msec;
+        if ( msec == 0 && p->resize_timer.isActive() )
+        {
+            p->resize_timer.stop();
+            p->renderSquare(size());
+            update();
+        }
+        Q_EMIT resizeDelayChanged(msec);
+    }
+}
 
 } // namespace color_widgets
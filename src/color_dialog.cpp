@@ -35,14 +35,63 @@ namespace color_widgets {
 class ColorDialog::Private
 {
 public:
+    /**
+     * \brief Color components the Ui elements depend on
+     */
+    enum Channel
+    {
+        Red         = 0x01,
+        Green       = 0x02,
+        Blue        = 0x04,
+        Hue         = 0x08,
+        Saturation  = 0x10,
+        Value       = 0x20,
+        Alpha       = 0x40,
+        AllChannels = 0x7f
+    };
+
     Ui_ColorDialog ui;
     ButtonMode button_mode;
     bool pick_from_screen;
     bool alpha_enabled;
-
-    Private() : pick_from_screen(false), alpha_enabled(true)
+    /// Widgets updated by sync_widgets(), their signals are blocked meanwhile
+    QList<QWidget*> synced_widgets;
+    /// Color currently displayed by the Ui elements
+    QColor shown_color;
+    qreal shown_hue;
+    qreal shown_saturation;
+    qreal shown_value;
+    bool update_pending;
+
+    Private() : pick_from_screen(false), alpha_enabled(true),
+        shown_hue(0), shown_saturation(0), shown_value(0), update_pending(false)
     {}
 
+    /**
+     * \brief Channels that differ from the displayed color
+     */
+    int changed_channels(const QColor& col, qreal hue, qreal sat, qreal val) const
+    {
+        if ( !shown_color.isValid() )
+            return AllChannels;
+
+        int channels = 0;
+        if ( col.red() != shown_color.red() )
+            channels |= Red;
+        if ( col.green() != shown_color.green() )
+            channels |= Green;
+        if ( col.blue() != shown_color.blue() )
+            channels |= Blue;
+        if ( col.alpha() != shown_color.alpha() )
+            channels |= Alpha;
+        if ( hue != shown_hue )
+            channels |= Hue;
+        if ( sat != shown_saturation )
+            channels |= Saturation;
+        if ( val != shown_value )
+            channels |= Value;
+        return channels;
+    }
 };
 
 ColorDialog::ColorDialog(QWidget *parent, Qt::WindowFlags f) :
@@ -58,6 +107,16 @@ ColorDialog::ColorDialog(QWidget *parent, Qt::WindowFlags f) :
 
     setButtonMode(OkApplyCancel);
 
+    p->synced_widgets
+        << p->ui.slide_red << p->ui.spin_red
+        << p->ui.slide_green << p->ui.spin_green
+        << p->ui.slide_blue << p->ui.spin_blue
+        << p->ui.slide_hue << p->ui.spin_hue
+        << p->ui.slide_saturation << p->ui.spin_saturation
+        << p->ui.slide_value << p->ui.spin_value
+        << p->ui.slide_alpha << p->ui.spin_alpha
+        << p->ui.edit_hex << p->ui.preview;
+
     connect(p->ui.wheel,&ColorWheel::displayFlagsChanged,this, &ColorDialog::wheelFlagsChanged);
 }
 
@@ -94,7 +153,7 @@ void ColorDialog::setColorInternal(const QColor &c)
      */
     p->ui.wheel->setColor(c);
     p->ui.slide_alpha->setValue(c.alpha());
-    update_widgets();
+    sync_widgets(true);
 }
 
 void ColorDialog::showColor(const QColor &c)
@@ -158,58 +217,131 @@ ColorDialog::ButtonMode ColorDialog::buttonMode() const
 
 void ColorDialog::update_widgets()
 {
-    bool blocked = signalsBlocked();
-    blockSignals(true);
-    Q_FOREACH(QWidget* w, findChildren<QWidget*>())
-        w->blockSignals(true);
+    // Wheel and slider drags can change the color several times per event
+    // loop iteration, only the last one needs to be displayed
+    if ( p->update_pending )
+        return;
+    p->update_pending = true;
+    QMetaObject::invokeMethod(this, "flush_update", Qt::QueuedConnection);
+}
+
+void ColorDialog::flush_update()
+{
+    if ( p->update_pending )
+        sync_widgets(false);
+}
+
+void ColorDialog::sync_widgets(bool all)
+{
+    p->update_pending = false;
 
     QColor col = color();
+    // Conversions are cached by the wheel, each is computed once per color
+    const CachedColor& current = p->ui.wheel->cachedColor();
+    QColor rgb = current.rgb();
+    rgb.setAlpha(col.alpha());
+    qreal hue = p->ui.wheel->hue();
+    qreal sat = current.hsvSaturationF();
+    qreal val = current.valueF();
+
+    int changed = all ? int(Private::AllChannels) : p->changed_channels(rgb, hue, sat, val);
+    if ( !changed )
+        return;
 
-    p->ui.slide_red->setValue(col.red());
-    p->ui.spin_red->setValue(p->ui.slide_red->value());
-    p->ui.slide_red->setFirstColor(QColor(0,col.green(),col.blue()));
-    p->ui.slide_red->setLastColor(QColor(255,col.green(),col.blue()));
+    bool blocked = signalsBlocked();
+    blockSignals(true);
+    Q_FOREACH(QWidget* w, p->synced_widgets)
+        w->blockSignals(true);
 
-    p->ui.slide_green->setValue(col.green());
-    p->ui.spin_green->setValue(p->ui.slide_green->value());
-    p->ui.slide_green->setFirstColor(QColor(col.red(),0,col.blue()));
-    p->ui.slide_green->setLastColor(QColor(col.red(),255,col.blue()));
+    if ( changed & Private::Red )
+    {
+        p->ui.slide_red->setValue(rgb.red());
+        p->ui.spin_red->setValue(p->ui.slide_red->value());
+    }
+    if ( changed & (Private::Green|Private::Blue) )
+    {
+        p->ui.slide_red->setFirstColor(QColor(0,rgb.green(),rgb.blue()));
+        p->ui.slide_red->setLastColor(QColor(255,rgb.green(),rgb.blue()));
+    }
 
-    p->ui.slide_blue->setValue(col.blue());
-    p->ui.spin_blue->setValue(p->ui.slide_blue->value());
-    p->ui.slide_blue->setFirstColor(QColor(col.red(),col.green(),0));
-    p->ui.slide_blue->setLastColor(QColor(col.red(),col.green(),255));
+    if ( changed & Private::Green )
+    {
+        p->ui.slide_green->setValue(rgb.green());
+        p->ui.spin_green->setValue(p->ui.slide_green->value());
+    }
+    if ( changed & (Private::Red|Private::Blue) )
+    {
+        p->ui.slide_green->setFirstColor(QColor(rgb.red(),0,rgb.blue()));
+        p->ui.slide_green->setLastColor(QColor(rgb.red(),255,rgb.blue()));
+    }
 
-    p->ui.slide_hue->setValue(qRound(p->ui.wheel->hue()*360.0));
-    p->ui.slide_hue->setColorSaturation(p->ui.wheel->saturation());
-    p->ui.slide_hue->setColorValue(p->ui.wheel->value());
-    p->ui.spin_hue->setValue(p->ui.slide_hue->value());
+    if ( changed & Private::Blue )
+    {
+        p->ui.slide_blue->setValue(rgb.blue());
+        p->ui.spin_blue->setValue(p->ui.slide_blue->value());
+    }
+    if ( changed & (Private::Red|Private::Green) )
+    {
+        p->ui.slide_blue->setFirstColor(QColor(rgb.red(),rgb.green(),0));
+        p->ui.slide_blue->setLastColor(QColor(rgb.red(),rgb.green(),255));
+    }
 
-    p->ui.slide_saturation->setValue(qRound(p->ui.wheel->saturation()*255.0));
-    p->ui.spin_saturation->setValue(p->ui.slide_saturation->value());
-    p->ui.slide_saturation->setFirstColor(QColor::fromHsvF(p->ui.wheel->hue(),0,p->ui.wheel->value()));
-    p->ui.slide_saturation->setLastColor(QColor::fromHsvF(p->ui.wheel->hue(),1,p->ui.wheel->value()));
+    if ( changed & Private::Hue )
+    {
+        p->ui.slide_hue->setValue(qRound(hue*360.0));
+        p->ui.spin_hue->setValue(p->ui.slide_hue->value());
+    }
+    if ( changed & (Private::Saturation|Private::Value) )
+    {
+        p->ui.slide_hue->setColorSaturation(sat);
+        p->ui.slide_hue->setColorValue(val);
+    }
 
-    p->ui.slide_value->setValue(qRound(p->ui.wheel->value()*255.0));
-    p->ui.spin_value->setValue(p->ui.slide_value->value());
-    p->ui.slide_value->setFirstColor(QColor::fromHsvF(p->ui.wheel->hue(), p->ui.wheel->saturation(),0));
-    p->ui.slide_value->setLastColor(QColor::fromHsvF(p->ui.wheel->hue(), p->ui.wheel->saturation(),1));
+    if ( changed & Private::Saturation )
+    {
+        p->ui.slide_saturation->setValue(qRound(sat*255.0));
+        p->ui.spin_saturation->setValue(p->ui.slide_saturation->value());
+    }
+    if ( changed & (Private::Hue|Private::Value) )
+    {
+        p->ui.slide_saturation->setFirstColor(QColor::fromHsvF(hue,0,val));
+        p->ui.slide_saturation->setLastColor(QColor::fromHsvF(hue,1,val));
+    }
 
+    if ( changed & Private::Value )
+    {
+        p->ui.slide_value->setValue(qRound(val*255.0));
+        p->ui.spin_value->setValue(p->ui.slide_value->value());
+    }
+    if ( changed & (Private::Hue|Private::Saturation) )
+    {
+        p->ui.slide_value->setFirstColor(QColor::fromHsvF(hue,sat,0));
+        p->ui.slide_value->setLastColor(QColor::fromHsvF(hue,sat,1));
+    }
 
-    QColor apha_color = col;
-    apha_color.setAlpha(0);
-    p->ui.slide_alpha->setFirstColor(apha_color);
-    apha_color.setAlpha(255);
-    p->ui.slide_alpha->setLastColor(apha_color);
-    p->ui.spin_alpha->setValue(p->ui.slide_alpha->value());
+    if ( changed & (Private::Red|Private::Green|Private::Blue) )
+    {
+        QColor apha_color = rgb;
+        apha_color.setAlpha(0);
+        p->ui.slide_alpha->setFirstColor(apha_color);
+        apha_color.setAlpha(255);
+        p->ui.slide_alpha->setLastColor(apha_color);
+    }
+    if ( changed & Private::Alpha )
+        p->ui.spin_alpha->setValue(p->ui.slide_alpha->value());
 
     if ( !p->ui.edit_hex->isModified() )
         p->ui.edit_hex->setColor(col);
 
     p->ui.preview->setColor(col);
 
+    p->shown_color = rgb;
+    p->shown_hue = hue;
+    p->shown_saturation = sat;
+    p->shown_value = val;
+
     blockSignals(blocked);
-    Q_FOREACH(QWidget* w, findChildren<QWidget*>())
+    Q_FOREACH(QWidget* w, p->synced_widgets)
         w->blockSignals(false);
 
     Q_EMIT colorChanged(col);
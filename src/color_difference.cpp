@@ -0,0 +1,389 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "color_difference.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <QPair>
+#include "color_palette.hpp"
+#include "color_utils.hpp"
+
+namespace color_widgets {
+
+namespace {
+
+/**
+ * \brief Coordinates in either CIE L*a*b* or OKLab depending on the metric
+ */
+struct LabPoint
+{
+    float l, a, b;
+};
+
+LabPoint to_point(const QColor& color, ColorDifference metric)
+{
+    QColor rgb = color.toRgb();
+    float r = detail::srgb_to_linear(rgb.redF());
+    float g = detail::srgb_to_linear(rgb.greenF());
+    float b = detail::srgb_to_linear(rgb.blueF());
+
+    if ( metric == DeltaEOklab )
+    {
+        detail::Oklab lab = detail::linear_rgb_to_oklab(r, g, b);
+        return LabPoint{lab.l, lab.a, lab.b};
+    }
+
+    detail::CieLab lab = detail::linear_rgb_to_cielab(r, g, b);
+    return LabPoint{lab.l, lab.a, lab.b};
+}
+
+QVector<LabPoint> to_points(const QVector<QColor>& colors, int count, ColorDifference metric)
+{
+    QVector<LabPoint> points(count);
+    LabPoint* data = points.data();
+    detail::parallel_for(count, [data, &colors, metric](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+            data[i] = to_point(colors[i], metric);
+    }, 4096);
+    return points;
+}
+
+float euclidean(const LabPoint& p1, const LabPoint& p2)
+{
+    float dl = p1.l - p2.l;
+    float da = p1.a - p2.a;
+    float db = p1.b - p2.b;
+    return std::sqrt(dl * dl + da * da + db * db);
+}
+
+/**
+ * \brief CIEDE2000, following Sharma, Wu and Dalal (2005)
+ */
+float ciede2000(const LabPoint& p1, const LabPoint& p2)
+{
+    static const double pi = 3.14159265358979323846;
+    static const double pow25_7 = 6103515625.0; // 25^7
+
+    auto deg = [](double rad) { return rad * 180 / pi; };
+    auto rad = [](double deg) { return deg * pi / 180; };
+
+    double c1 = std::hypot(p1.a, p1.b);
+    double c2 = std::hypot(p2.a, p2.b);
+    double c_mean7 = std::pow((c1 + c2) / 2, 7);
+    double g = 0.5 * (1 - std::sqrt(c_mean7 / (c_mean7 + pow25_7)));
+
+    double a1 = (1 + g) * p1.a;
+    double a2 = (1 + g) * p2.a;
+    double c1p = std::hypot(a1, double(p1.b));
+    double c2p = std::hypot(a2, double(p2.b));
+    double h1p = c1p == 0 ? 0 : deg(std::atan2(double(p1.b), a1));
+    double h2p = c2p == 0 ? 0 : deg(std::atan2(double(p2.b), a2));
+    if ( h1p < 0 ) h1p += 360;
+    if ( h2p < 0 ) h2p += 360;
+
+    double dlp = p2.l - p1.l;
+    double dcp = c2p - c1p;
+    double dhp = 0;
+    if ( c1p * c2p != 0 )
+    {
+        dhp = h2p - h1p;
+        if ( dhp > 180 )
+            dhp -= 360;
+        else if ( dhp < -180 )
+            dhp += 360;
+    }
+    double dhp_big = 2 * std::sqrt(c1p * c2p) * std::sin(rad(dhp / 2));
+
+    double lp_mean = (p1.l + p2.l) / 2.0;
+    double cp_mean = (c1p + c2p) / 2;
+    double hp_mean = h1p + h2p;
+    if ( c1p * c2p != 0 )
+    {
+        if ( std::abs(h1p - h2p) <= 180 )
+            hp_mean /= 2;
+        else if ( hp_mean < 360 )
+            hp_mean = (hp_mean + 360) / 2;
+        else
+            hp_mean = (hp_mean - 360) / 2;
+    }
+
+    double t = 1
+        - 0.17 * std::cos(rad(hp_mean - 30))
+        + 0.24 * std::cos(rad(2 * hp_mean))
+        + 0.32 * std::cos(rad(3 * hp_mean + 6))
+        - 0.20 * std::cos(rad(4 * hp_mean - 63));
+    double d_theta = 30 * std::exp(-std::pow((hp_mean - 275) / 25, 2));
+    double cp_mean7 = std::pow(cp_mean, 7);
+    double rc = 2 * std::sqrt(cp_mean7 / (cp_mean7 + pow25_7));
+    double lp_offset = (lp_mean - 50) * (lp_mean - 50);
+    double sl = 1 + 0.015 * lp_offset / std::sqrt(20 + lp_offset);
+    double sc = 1 + 0.045 * cp_mean;
+    double sh = 1 + 0.015 * cp_mean * t;
+    double rt = -std::sin(rad(2 * d_theta)) * rc;
+
+    double tl = dlp / sl;
+    double tc = dcp / sc;
+    double th = dhp_big / sh;
+    return float(std::sqrt(tl * tl + tc * tc + th * th + rt * tc * th));
+}
+
+float point_difference(const LabPoint& p1, const LabPoint& p2, ColorDifference metric)
+{
+    if ( metric == DeltaE2000 )
+        return ciede2000(p1, p2);
+    return euclidean(p1, p2);
+}
+
+/**
+ * \brief Fills \p out[i] with the difference between \p a[i] and \p b[i]
+ *
+ * Picks the kernel once so the euclidean loop is a straight arithmetic loop.
+ */
+void point_differences(const LabPoint* a, const LabPoint* b, float* out,
+                       int count, ColorDifference metric)
+{
+    if ( metric == DeltaE2000 )
+    {
+        for ( int i = 0; i < count; i++ )
+            out[i] = ciede2000(a[i], b[i]);
+    }
+    else
+    {
+        for ( int i = 0; i < count; i++ )
+            out[i] = euclidean(a[i], b[i]);
+    }
+}
+
+/**
+ * \brief Fills \p out[i] with the difference between \p pivot and \p others[i]
+ */
+void point_differences(const LabPoint& pivot, const LabPoint* others, float* out,
+                       int count, ColorDifference metric)
+{
+    if ( metric == DeltaE2000 )
+    {
+        for ( int i = 0; i < count; i++ )
+            out[i] = ciede2000(pivot, others[i]);
+    }
+    else
+    {
+        for ( int i = 0; i < count; i++ )
+            out[i] = euclidean(pivot, others[i]);
+    }
+}
+
+/**
+ * \brief Upper bound of ΔE76 / ΔE2000 for colors with chroma up to \p max_chroma
+ *
+ * With a', C' and H' as in CIEDE2000, ΔE76 is at most the euclidean distance
+ * in L*a'b* (a' = (1 + G) a*, G >= 0), which is sqrt(ΔL'² + ΔC'² + ΔH'²).
+ * ΔE2000² is (ΔL'/S_L)² + x² + y² + R_T x y with x = ΔC'/S_C, y = ΔH'/S_H,
+ * and since |R_T| <= 2 sin(60°) the last three terms are at least
+ * (1 - |R_T| / 2)(x² + y²). S_H <= S_C and S_L <= 1.75, while S_C grows with
+ * the mean C', which is at most (1 + G(C)) C for the largest chroma C.
+ */
+float ciede2000_radius_factor(float max_chroma)
+{
+    double c7 = std::pow(double(max_chroma), 7);
+    double g = 0.5 * (1 - std::sqrt(c7 / (c7 + 6103515625.0)));
+    double sc_max = 1 + 0.045 * (1 + g) * max_chroma;
+    double rt_factor = std::sqrt(1 - std::sin(60 * 3.14159265358979323846 / 180));
+    return float(qMax(1.75, sc_max / rt_factor));
+}
+
+} // namespace
+
+qreal deltaE76(const QColor& a, const QColor& b)
+{
+    return colorDifference(a, b, DeltaE76);
+}
+
+qreal deltaE2000(const QColor& a, const QColor& b)
+{
+    return colorDifference(a, b, DeltaE2000);
+}
+
+qreal deltaEOklab(const QColor& a, const QColor& b)
+{
+    return colorDifference(a, b, DeltaEOklab);
+}
+
+qreal colorDifference(const QColor& a, const QColor& b, ColorDifference metric)
+{
+    return point_difference(to_point(a, metric), to_point(b, metric), metric);
+}
+
+QVector<float> colorDifferences(const QVector<QColor>& a,
+                                const QVector<QColor>& b,
+                                ColorDifference metric)
+{
+    int count = qMin(a.size(), b.size());
+    QVector<LabPoint> points_a = to_points(a, count, metric);
+    QVector<LabPoint> points_b = to_points(b, count, metric);
+    QVector<float> out(count);
+
+    const LabPoint* data_a = points_a.constData();
+    const LabPoint* data_b = points_b.constData();
+    float* data_out = out.data();
+    detail::parallel_for(count, [=](int begin, int end) {
+        point_differences(data_a + begin, data_b + begin, data_out + begin,
+                          end - begin, metric);
+    }, 4096);
+    return out;
+}
+
+QVector<float> colorDifferenceMatrix(const QVector<QColor>& colors,
+                                     ColorDifference metric)
+{
+    const int count = colors.size();
+    if ( qint64(count) * count > max_difference_matrix_size )
+        return QVector<float>();
+
+    QVector<LabPoint> points = to_points(colors, count, metric);
+    QVector<float> matrix(count * count, 0.f);
+
+    const LabPoint* data = points.constData();
+    float* out = matrix.data();
+    // Each task takes row i and row count-1-i, so they all compute
+    // about the same number of cells of the upper triangle
+    detail::parallel_for((count + 1) / 2, [=](int begin, int end) {
+        auto compute_row = [&](int i) {
+            int others = count - i - 1;
+            if ( others <= 0 )
+                return;
+            // The upper triangle part of the row is contiguous
+            float* row = out + qint64(i) * count + i + 1;
+            point_differences(data[i], data + i + 1, row, others, metric);
+            for ( int k = 0; k < others; k++ )
+                out[qint64(i + 1 + k) * count + i] = row[k];
+        };
+
+        for ( int fold = begin; fold < end; fold++ )
+        {
+            compute_row(fold);
+            if ( count - 1 - fold != fold )
+                compute_row(count - 1 - fold);
+        }
+    }, 8);
+    return matrix;
+}
+
+QVector<int> findSimilarColors(const QVector<QColor>& colors,
+                               qreal threshold,
+                               ColorDifference metric)
+{
+    const int count = colors.size();
+    QVector<int> result(count, -1);
+    if ( count < 2 || threshold < 0 )
+        return result;
+
+    QVector<LabPoint> points = to_points(colors, count, metric);
+    const LabPoint* data = points.constData();
+
+    // Candidates for ΔE2000 are gathered in a wider CIE L*a*b* radius,
+    // scaled by the bound from ciede2000_radius_factor()
+    float radius = threshold;
+    if ( metric == DeltaE2000 )
+    {
+        float max_chroma = 0;
+        for ( const LabPoint& point : points )
+            max_chroma = qMax(max_chroma, std::hypot(point.a, point.b));
+        // Slightly larger to absorb rounding errors
+        radius = threshold * ciede2000_radius_factor(max_chroma) * 1.01f;
+    }
+    float cell_size = qMax(radius, metric == DeltaEOklab ? 1e-5f : 1e-3f);
+
+    auto cell_of = [cell_size](float value) {
+        return qint64(std::floor(value / cell_size));
+    };
+    auto cell_key = [](qint64 l, qint64 a, qint64 b) {
+        const qint64 offset = 1 << 20;
+        return quint64(l + offset) << 42 | quint64(a + offset) << 21 | quint64(b + offset);
+    };
+
+    // Colors sorted by cell, indices within a cell stay in ascending order
+    QVector<QPair<quint64, int>> cells(count);
+    QPair<quint64, int>* cell_data = cells.data();
+    detail::parallel_for(count, [&](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+            cell_data[i] = qMakePair(cell_key(cell_of(data[i].l), cell_of(data[i].a), cell_of(data[i].b)), i);
+    }, 4096);
+    detail::parallel_stable_sort(cell_data, count,
+        [](const QPair<quint64, int>& a, const QPair<quint64, int>& b) {
+            return a.first < b.first;
+        });
+
+    // For each color, the earlier colors within the threshold
+    std::vector<std::vector<int>> similar(count);
+    detail::parallel_for(count, [&](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+        {
+            const LabPoint& point = data[i];
+            qint64 cl = cell_of(point.l), ca = cell_of(point.a), cb = cell_of(point.b);
+            std::vector<int>& found = similar[i];
+            for ( qint64 dl = -1; dl <= 1; dl++ )
+            for ( qint64 da = -1; da <= 1; da++ )
+            for ( qint64 db = -1; db <= 1; db++ )
+            {
+                quint64 key = cell_key(cl + dl, ca + da, cb + db);
+                auto range = std::equal_range(cell_data, cell_data + count,
+                    qMakePair(key, 0),
+                    [](const QPair<quint64, int>& a, const QPair<quint64, int>& b) {
+                        return a.first < b.first;
+                    });
+                for ( auto it = range.first; it != range.second && it->second < i; ++it )
+                {
+                    const LabPoint& other = data[it->second];
+                    // CIEDE2000 lightness weighting is at most 1.75
+                    if ( metric == DeltaE2000 && std::abs(other.l - point.l) > threshold * 1.75f )
+                        continue;
+                    if ( point_difference(point, other, metric) <= threshold )
+                        found.push_back(it->second);
+                }
+            }
+            std::sort(found.begin(), found.end());
+        }
+    }, 256);
+
+    for ( int i = 0; i < count; i++ )
+    {
+        for ( int j : similar[i] )
+        {
+            if ( result[j] == -1 )
+            {
+                result[i] = j;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+QVector<float> colorDifferenceMatrix(const ColorPalette& palette,
+                                     ColorDifference metric)
+{
+    return colorDifferenceMatrix(palette.onlyColors(), metric);
+}
+
+} // namespace color_widgets
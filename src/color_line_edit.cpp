@@ -27,6 +27,8 @@
 #include <QApplication>
 #include <QPainter>
 #include <QStyleOptionFrame>
+#include <QHelpEvent>
+#include <QToolTip>
 
 #include "color_utils.hpp"
 #include "color_names.hpp"
@@ -195,6 +197,19 @@ void ColorLineEdit::setPreviewColor(bool previewColor)
     }
 }
 
+bool ColorLineEdit::event(QEvent* event)
+{
+    // Show the closest color name unless a tooltip has been set explicitly
+    if ( event->type() == QEvent::ToolTip && toolTip().isEmpty() && p->color.isValid() )
+    {
+        QHelpEvent* help_ev = static_cast<QHelpEvent*>(event);
+        QToolTip::showText(help_ev->globalPos(), detail::color_name_hint(p->color), this);
+        return true;
+    }
+
+    return QLineEdit::event(event);
+}
+
 void ColorLineEdit::paintEvent(QPaintEvent* event)
 {
     if ( p->customAlpha() )
@@ -0,0 +1,444 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "color_list_view.hpp"
+#include "color_dialog.hpp"
+#include "color_names.hpp"
+
+#include <QAbstractListModel>
+#include <QApplication>
+#include <QListView>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPersistentModelIndex>
+#include <QPushButton>
+#include <QStyledItemDelegate>
+#include <QStyleOptionToolButton>
+#include <QVBoxLayout>
+
+namespace color_widgets {
+
+namespace {
+
+/// Row height and button size, as in ColorListWidget
+const int row_height = 22;
+const int swatch_width = 128;
+
+class ColorListModel : public QAbstractListModel
+{
+public:
+    QList<QColor> colors;
+
+    explicit ColorListModel(QObject* parent)
+        : QAbstractListModel(parent)
+    {}
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE
+    {
+        return parent.isValid() ? 0 : colors.size();
+    }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE
+    {
+        if ( !index.isValid() || index.row() >= colors.size() )
+            return QVariant();
+
+        switch ( role )
+        {
+            case Qt::DisplayRole:
+            case Qt::EditRole:
+            case Qt::DecorationRole:
+                return colors[index.row()];
+            case Qt::ToolTipRole:
+                return stringFromColor(colors[index.row()]);
+            default:
+                return QVariant();
+        }
+    }
+
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) Q_DECL_OVERRIDE
+    {
+        if ( !index.isValid() || index.row() >= colors.size() ||
+             role != Qt::EditRole || !value.canConvert<QColor>() )
+            return false;
+
+        QColor color = value.value<QColor>();
+        if ( colors[index.row()] != color )
+        {
+            colors[index.row()] = color;
+            Q_EMIT dataChanged(index, index);
+        }
+        return true;
+    }
+
+    Qt::ItemFlags flags(const QModelIndex& index) const Q_DECL_OVERRIDE
+    {
+        if ( !index.isValid() )
+            return Qt::NoItemFlags;
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable |
+               Qt::ItemNeverHasChildren;
+    }
+
+    bool removeRows(int row, int count, const QModelIndex& parent = QModelIndex()) Q_DECL_OVERRIDE
+    {
+        if ( parent.isValid() || row < 0 || count <= 0 || row + count > colors.size() )
+            return false;
+
+        beginRemoveRows(QModelIndex(), row, row + count - 1);
+        colors.erase(colors.begin() + row, colors.begin() + row + count);
+        endRemoveRows();
+        return true;
+    }
+
+    void append(const QColor& color)
+    {
+        beginInsertRows(QModelIndex(), colors.size(), colors.size());
+        colors.push_back(color);
+        endInsertRows();
+    }
+
+    void reset(const QList<QColor>& new_colors)
+    {
+        beginResetModel();
+        colors = new_colors;
+        endResetModel();
+    }
+
+    /**
+     * \brief Swaps two colors, with a single dataChanged()
+     */
+    void swap(int a, int b)
+    {
+        colors.swap(a, b);
+        Q_EMIT dataChanged(index(qMin(a, b)), index(qMax(a, b)));
+    }
+};
+
+/**
+ * \brief Like QStyleOption::initFrom(), but from the item option
+ *
+ * The view isn't always available as option.widget (eg: when the delegate
+ * is used to render offscreen).
+ */
+void init_from_item(QStyleOption& out, const QStyleOptionViewItem& option)
+{
+    out.state = option.state &
+        (QStyle::State_Enabled | QStyle::State_Active | QStyle::State_Window);
+    out.direction = option.direction;
+    out.fontMetrics = option.fontMetrics;
+    out.palette = option.palette;
+    out.styleObject = option.styleObject;
+}
+
+/**
+ * \brief Paints a row as a color swatch followed by move up, move down and
+ * remove buttons, and handles clicks on them
+ */
+class ColorListDelegate : public QStyledItemDelegate
+{
+public:
+    enum Part
+    {
+        Swatch,
+        MoveUp,
+        MoveDown,
+        Remove,
+        Nothing
+    };
+
+    explicit ColorListDelegate(ColorListView* view)
+        : QStyledItemDelegate(view), view(view),
+          back(Qt::darkGray, Qt::DiagCrossPattern)
+    {
+        back.setTexture(QPixmap(QStringLiteral(":/color_widgets/alphaback.png")));
+        icons[0] = QIcon::fromTheme(QStringLiteral("go-up"));
+        icons[1] = QIcon::fromTheme(QStringLiteral("go-down"));
+        icons[2] = QIcon::fromTheme(QStringLiteral("list-remove"));
+        texts[0] = ColorListView::tr("Move Up");
+        texts[1] = ColorListView::tr("Move Down");
+        texts[2] = ColorListView::tr("Remove");
+    }
+
+    static QRect part_rect(const QRect& rect, Part part)
+    {
+        int button = rect.height();
+        if ( part == Swatch )
+            return QRect(rect.left(), rect.top(), rect.width() - 3 * button, rect.height());
+        int from_right = Remove - part + 1;
+        return QRect(rect.right() + 1 - from_right * button, rect.top(), button, button);
+    }
+
+    static Part part_at(const QRect& rect, const QPoint& pos)
+    {
+        for ( int part = Swatch; part < Nothing; part++ )
+            if ( part_rect(rect, Part(part)).contains(pos) )
+                return Part(part);
+        return Nothing;
+    }
+
+    static bool part_enabled(Part part, const QModelIndex& index)
+    {
+        if ( part == MoveUp )
+            return index.row() > 0;
+        if ( part == MoveDown )
+            return index.row() + 1 < index.model()->rowCount();
+        return part != Nothing;
+    }
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option,
+               const QModelIndex& index) const Q_DECL_OVERRIDE
+    {
+        const QWidget* widget = option.widget;
+        QStyle* style = widget ? widget->style() : QApplication::style();
+        style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, widget);
+
+        painter->save();
+        QColor color = index.data().value<QColor>();
+        QStyleOptionFrame panel;
+        init_from_item(panel, option);
+        panel.rect = part_rect(option.rect, Swatch);
+        panel.lineWidth = 2;
+        panel.midLineWidth = 0;
+        panel.state |= QStyle::State_Sunken;
+        style->drawPrimitive(QStyle::PE_Frame, &panel, painter, widget);
+        QRect r = style->subElementRect(QStyle::SE_FrameContents, &panel, widget);
+        if ( color.alpha() < 255 )
+            painter->fillRect(r, back);
+        painter->fillRect(r, color);
+        painter->restore();
+
+        for ( int part = MoveUp; part <= Remove; part++ )
+        {
+            QStyleOptionToolButton button;
+            init_from_item(button, option);
+            button.rect = part_rect(option.rect, Part(part));
+            button.icon = icons[part - MoveUp];
+            button.text = texts[part - MoveUp];
+            button.iconSize = QSize(16, 16);
+            button.toolButtonStyle = button.icon.isNull() ?
+                Qt::ToolButtonTextOnly : Qt::ToolButtonIconOnly;
+            button.subControls = QStyle::SC_ToolButton;
+            button.state |= QStyle::State_AutoRaise | QStyle::State_Raised;
+            if ( !part_enabled(Part(part), index) )
+                button.state &= ~QStyle::State_Enabled;
+            style->drawComplexControl(QStyle::CC_ToolButton, &button, painter, widget);
+        }
+    }
+
+    bool editorEvent(QEvent* event, QAbstractItemModel* model,
+                     const QStyleOptionViewItem& option,
+                     const QModelIndex& index) Q_DECL_OVERRIDE
+    {
+        if ( event->type() == QEvent::MouseButtonRelease )
+        {
+            QMouseEvent* mouse_event = static_cast<QMouseEvent*>(event);
+            Part part = part_at(option.rect, mouse_event->pos());
+            if ( mouse_event->button() == Qt::LeftButton && part_enabled(part, index) )
+            {
+                int row = index.row();
+                switch ( part )
+                {
+                    case Swatch:
+                        view->editColor(row);
+                        break;
+                    case MoveUp:
+                        view->swap(row, row - 1);
+                        break;
+                    case MoveDown:
+                        view->swap(row, row + 1);
+                        break;
+                    default:
+                        // The view is still handling the event for this row
+                        QMetaObject::invokeMethod(view, "remove", Qt::QueuedConnection,
+                                                  Q_ARG(int, row));
+                        break;
+                }
+                return true;
+            }
+        }
+
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem&, const QModelIndex&) const Q_DECL_OVERRIDE
+    {
+        return QSize(swatch_width + 3 * row_height, row_height);
+    }
+
+private:
+    ColorListView* view;
+    QBrush back;
+    QIcon icons[3];
+    QString texts[3];
+};
+
+} // namespace
+
+class ColorListView::Private
+{
+public:
+    ColorListModel* model;
+    QListView* view;
+    /// Created the first time a color is edited
+    ColorDialog* dialog = nullptr;
+    /// Row being edited by the dialog
+    QPersistentModelIndex editing;
+    QColor original_color;
+    ColorWheel::DisplayFlags wheel_flags = ColorWheel::defaultDisplayFlags();
+
+    /**
+     * \brief Hides the dialog if the row it was editing is gone
+     */
+    void check_editing()
+    {
+        if ( dialog && !editing.isValid() )
+            dialog->hide();
+    }
+};
+
+ColorListView::ColorListView(QWidget *parent)
+    : QWidget(parent), p(new Private)
+{
+    p->model = new ColorListModel(this);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    // Uniform sizes let the view lay out only the visible rows
+    p->view = new QListView(this);
+    p->view->setUniformItemSizes(true);
+    p->view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    p->view->setItemDelegate(new ColorListDelegate(this));
+    p->view->setModel(p->model);
+    layout->addWidget(p->view);
+
+    QPushButton* add_button = new QPushButton(QIcon::fromTheme(QStringLiteral("list-add")),
+                                              tr("Add New"));
+    layout->addWidget(add_button);
+    connect(add_button, &QAbstractButton::clicked, this, &ColorListView::append);
+
+    // Every change to the model is a single operation
+    auto emit_changed = [this]{ Q_EMIT colorsChanged(p->model->colors); };
+    connect(p->model, &QAbstractItemModel::dataChanged, this, emit_changed);
+    connect(p->model, &QAbstractItemModel::rowsInserted, this, emit_changed);
+    connect(p->model, &QAbstractItemModel::rowsRemoved, this, emit_changed);
+    connect(p->model, &QAbstractItemModel::modelReset, this, emit_changed);
+}
+
+ColorListView::~ColorListView()
+{
+    delete p;
+}
+
+QList<QColor> ColorListView::colors() const
+{
+    return p->model->colors;
+}
+
+void ColorListView::setColors(const QList<QColor>& colors)
+{
+    p->model->reset(colors);
+    p->check_editing();
+}
+
+int ColorListView::count() const
+{
+    return p->model->colors.size();
+}
+
+void ColorListView::swap(int a, int b)
+{
+    if ( !isValidRow(a) || !isValidRow(b) || a == b )
+        return;
+
+    // The dialog keeps editing the same color
+    if ( p->editing.isValid() && p->editing.row() == a )
+        p->editing = p->model->index(b);
+    else if ( p->editing.isValid() && p->editing.row() == b )
+        p->editing = p->model->index(a);
+
+    p->model->swap(a, b);
+}
+
+void ColorListView::append()
+{
+    p->model->append(Qt::black);
+    p->view->scrollToBottom();
+}
+
+void ColorListView::remove(int i)
+{
+    if ( isValidRow(i) )
+    {
+        p->model->removeRows(i, 1);
+        p->check_editing();
+    }
+}
+
+void ColorListView::editColor(int i)
+{
+    if ( !isValidRow(i) )
+        return;
+
+    if ( !p->dialog )
+    {
+        p->dialog = new ColorDialog(this);
+        p->dialog->setButtonMode(ColorDialog::OkCancel);
+        p->dialog->setWheelFlags(p->wheel_flags);
+
+        auto set_color = [this](const QColor& color) {
+            if ( p->editing.isValid() )
+                p->model->setData(p->editing, color);
+        };
+        connect(p->dialog, &ColorDialog::colorChanged, this, set_color);
+        connect(p->dialog, &ColorDialog::colorSelected, this, set_color);
+        connect(p->dialog, &QDialog::rejected, this, [this]{
+            if ( p->editing.isValid() )
+                p->model->setData(p->editing, p->original_color);
+        });
+        connect(p->dialog, &ColorDialog::wheelFlagsChanged,
+                this, &ColorListView::setWheelFlags);
+    }
+
+    // Changed before setColor() so the previous row isn't updated
+    p->editing = p->model->index(i);
+    p->original_color = p->model->colors[i];
+    p->dialog->setColor(p->original_color);
+    p->dialog->show();
+}
+
+ColorWheel::DisplayFlags ColorListView::wheelFlags() const
+{
+    return p->wheel_flags;
+}
+
+void ColorListView::setWheelFlags(ColorWheel::DisplayFlags flags)
+{
+    if ( p->wheel_flags != flags )
+    {
+        p->wheel_flags = flags;
+        Q_EMIT wheelFlagsChanged(flags);
+        if ( p->dialog )
+            p->dialog->setWheelFlags(flags);
+    }
+}
+
+} // namespace color_widgets
@@ -30,6 +30,8 @@ public:
     QList<QColor>               colors;
     QSignalMapper               mapper;
     ColorWheel::DisplayFlags  wheel_flags;
+    /// Set while the selectors are being updated from colors
+    bool                        updating = false;
 };
 
 ColorListWidget::ColorListWidget(QWidget *parent)
@@ -52,11 +54,40 @@ QList<QColor> ColorListWidget::colors() const
 
 void ColorListWidget::setColors(const QList<QColor> &colors)
 {
-    clear();
+    bool updates = updatesEnabled();
+    setUpdatesEnabled(false);
+
+    // Existing rows are reused, rows are added or removed only for the
+    // difference in size
+    int reused = qMin(count(), colors.size());
     p->colors = colors;
-    for(int i = 0;i < colors.size();i++ )
-        append_widget(i);
-    Q_EMIT colorsChanged(colors);
+    p->updating = true;
+    for ( int i = 0; i < reused; i++ )
+    {
+        ColorSelector* cs = widget_cast<ColorSelector>(i);
+        if ( cs && cs->color() != colors[i] )
+            cs->setColor(colors[i]);
+    }
+    p->updating = false;
+
+    if ( count() > colors.size() )
+    {
+        truncate(colors.size());
+    }
+    else if ( count() < colors.size() )
+    {
+        int first = count();
+        QList<QWidget*> widgets;
+        widgets.reserve(colors.size() - first);
+        for ( int i = first; i < colors.size(); i++ )
+            widgets.push_back(create_widget(i));
+        appendWidgets(widgets);
+        for ( int i = first; i < colors.size(); i++ )
+            setRowHeight(i,22);
+    }
+
+    setUpdatesEnabled(updates);
+    Q_EMIT colorsChanged(p->colors);
 }
 
 void ColorListWidget::swap(int a, int b)
@@ -65,9 +96,11 @@ void ColorListWidget::swap(int a, int b)
     ColorSelector* sb = widget_cast<ColorSelector>(b);
     if ( sa && sb )
     {
-        QColor ca = sa->color();
-        sa->setColor(sb->color());
-        sb->setColor(ca);
+        p->colors.swap(a, b);
+        p->updating = true;
+        sa->setColor(p->colors[a]);
+        sb->setColor(p->colors[b]);
+        p->updating = false;
         Q_EMIT colorsChanged(p->colors);
     }
 }
@@ -75,7 +108,8 @@ void ColorListWidget::swap(int a, int b)
 void ColorListWidget::append()
 {
     p->colors.push_back(Qt::black);
-    append_widget(p->colors.size()-1);
+    appendWidget(create_widget(p->colors.size()-1));
+    setRowHeight(count()-1,22);
     Q_EMIT colorsChanged(p->colors);
 }
 
@@ -87,11 +121,17 @@ void ColorListWidget::emit_changed()
 void ColorListWidget::handle_removed(int i)
 {
     p->colors.removeAt(i);
+    // The rows after the removed one moved up
+    for ( int row = i; row < count(); row++ )
+        p->mapper.setMapping(widget(row), row);
     Q_EMIT colorsChanged(p->colors);
 }
 
 void ColorListWidget::color_changed(int row)
 {
+    if ( p->updating )
+        return;
+
     ColorSelector *cs = widget_cast<ColorSelector>(row);
     if ( cs )
     {
@@ -100,18 +140,19 @@ void ColorListWidget::color_changed(int row)
     }
 }
 
-void ColorListWidget::append_widget(int col)
+QWidget* ColorListWidget::create_widget(int col)
 {
     ColorSelector* cbs = new ColorSelector;
     cbs->setDisplayMode(ColorPreview::AllAlpha);
+    cbs->setSharedDialog(true);
+    cbs->setWheelFlags(p->wheel_flags);
     cbs->setColor(p->colors[col]);
     //connect(cbs,SIGNAL(colorChanged(QColor)),SLOT(emit_changed()));
     p->mapper.setMapping(cbs,col);
     connect(cbs,SIGNAL(colorChanged(QColor)),&p->mapper,SLOT(map()));
     connect(this,&ColorListWidget::wheelFlagsChanged,
             cbs,&ColorSelector::setWheelFlags);
-    appendWidget(cbs);
-    setRowHeight(count()-1,22);
+    return cbs;
 }
 
 ColorWheel::DisplayFlags ColorListWidget::wheelFlags() const
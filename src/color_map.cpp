@@ -0,0 +1,153 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "color_map.hpp"
+
+#include <algorithm>
+#include "color_utils.hpp"
+#include "gradient_kernel.hpp"
+
+namespace color_widgets {
+
+/// Minimum number of values mapped by each thread
+static const int map_chunk = 1 << 16;
+
+ColorMap::ColorMap()
+{}
+
+ColorMap::ColorMap(const QGradientStops& stops,
+                   GradientSlider::Interpolation interpolation, int size)
+{
+    detail::GradientKernel kernel(stops, interpolation);
+    if ( kernel.isEmpty() || size <= 0 )
+        return;
+
+    lut.resize(size);
+    // The first and last entries are the ends of the gradient
+    kernel.render(lut.data(), size, 0, size > 1 ? 1.0 / (size - 1) : 0);
+    setRange(0, 1);
+}
+
+ColorMap::ColorMap(const GradientSlider& slider, int size)
+    : ColorMap(slider.colors(), slider.interpolation(), size)
+{}
+
+void ColorMap::setRange(qreal minimum, qreal maximum)
+{
+    min = minimum;
+    max = maximum;
+    // Negative when maximum < minimum, which inverts the map
+    scale = max != min ? (lut.size() - 1) / (max - min) : 0;
+}
+
+int ColorMap::index(float value) const
+{
+    float t = qBound(0.f, (value - min) * scale, float(lut.size() - 1));
+    return int(t + 0.5f);
+}
+
+QRgb ColorMap::map(float value) const
+{
+    if ( lut.isEmpty() )
+        return 0;
+    if ( value != value )
+        return nan_color;
+    return lut[index(value)];
+}
+
+void ColorMap::map(const float* values, QRgb* output, int count) const
+{
+    if ( lut.isEmpty() )
+    {
+        std::fill(output, output + count, QRgb(0));
+        return;
+    }
+
+    const QRgb* table = lut.constData();
+    detail::parallel_for(count, [this, table, values, output](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+        {
+            float value = values[i];
+            output[i] = value != value ? nan_color : table[index(value)];
+        }
+    }, map_chunk);
+}
+
+QVector<QRgb> ColorMap::direct_table(int count) const
+{
+    QVector<QRgb> table(count);
+    for ( int i = 0; i < count; i++ )
+        table[i] = lut.isEmpty() ? 0 : lut[index(i)];
+    return table;
+}
+
+void ColorMap::map(const quint16* values, QRgb* output, int count) const
+{
+    // A table for all the possible values costs less than scaling each one
+    // only when there are enough of them
+    if ( count < 0x10000 )
+    {
+        for ( int i = 0; i < count; i++ )
+            output[i] = map(float(values[i]));
+        return;
+    }
+
+    QVector<QRgb> direct = direct_table(0x10000);
+    const QRgb* table = direct.constData();
+    detail::parallel_for(count, [table, values, output](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+            output[i] = table[values[i]];
+    }, map_chunk);
+}
+
+void ColorMap::map(const quint8* values, QRgb* output, int count) const
+{
+    QVector<QRgb> direct = direct_table(0x100);
+    const QRgb* table = direct.constData();
+    detail::parallel_for(count, [table, values, output](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+            output[i] = table[values[i]];
+    }, map_chunk);
+}
+
+QImage ColorMap::mapImage(const float* values, const QSize& size) const
+{
+    QImage image(size, QImage::Format_ARGB32);
+    if ( image.isNull() )
+        return image;
+
+    // bits() detaches, so it's called here rather than from the workers
+    uchar* bits = image.bits();
+    int stride = image.bytesPerLine();
+    int width = size.width();
+    detail::parallel_for(size.height(), [this, bits, stride, width, values](int begin, int end) {
+        for ( int y = begin; y < end; y++ )
+        {
+            const float* row = values + qint64(y) * width;
+            QRgb* line = reinterpret_cast<QRgb*>(bits + qint64(y) * stride);
+            for ( int x = 0; x < width; x++ )
+                line[x] = map(row[x]);
+        }
+    }, qMax(1, map_chunk / qMax(1, width)));
+    return image;
+}
+
+} // namespace color_widgets
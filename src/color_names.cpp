@@ -20,70 +20,731 @@
  *
  */
 #include "color_names.hpp"
-#include <QRegularExpression>
-
-static QRegularExpression regex_qcolor (QStringLiteral("^(?:(?:#[[:xdigit:]]{3})|(?:#[[:xdigit:]]{6})|(?:[[:alpha:]]+))$"));
-static QRegularExpression regex_func_rgb (QStringLiteral(R"(^rgb\s*\(\s*([0-9]+)\s*,\s*([0-9]+)\s*,\s*([0-9]+)\s*\)$)"));
-static QRegularExpression regex_hex_rgba (QStringLiteral("^#[[:xdigit:]]{8}$"));
-static QRegularExpression regex_func_rgba (QStringLiteral(R"(^rgba?\s*\(\s*([0-9]+)\s*,\s*([0-9]+)\s*,\s*([0-9]+)\s*,\s*([0-9]+)\s*\)$)"));
+#include <cstring>
+#include <limits>
+#include "nearest_color.hpp"
 
 namespace color_widgets {
 
+namespace {
+
+/**
+ * \brief Lookup table from ASCII to hex digit values, -1 for other characters
+ */
+struct HexTable
+{
+    HexTable()
+    {
+        for ( int i = 0; i < 128; i++ )
+            values[i] = -1;
+        for ( int i = 0; i < 10; i++ )
+            values['0' + i] = i;
+        for ( int i = 0; i < 6; i++ )
+            values['a' + i] = values['A' + i] = 10 + i;
+    }
+
+    signed char values[128];
+};
+
+const HexTable hex_table;
+
+/**
+ * \brief Value of a hex digit, -1 if \p c isn't one
+ */
+int hex_digit(QChar c)
+{
+    ushort u = c.unicode();
+    return u < 128 ? hex_table.values[u] : -1;
+}
+
+/**
+ * \brief Parses the digits after '#' in #rgb, #rrggbb or #rrggbbaa
+ */
+QColor parse_hex(const QChar* begin, const QChar* end, bool alpha)
+{
+    int length = end - begin;
+    if ( length != 3 && length != 6 && !(alpha && length == 8) )
+        return QColor();
+
+    int digits[8];
+    for ( int i = 0; i < length; i++ )
+        if ( (digits[i] = hex_digit(begin[i])) < 0 )
+            return QColor();
+
+    if ( length == 3 )
+        return QColor(digits[0] * 17, digits[1] * 17, digits[2] * 17);
+
+    QColor color(
+        digits[0] << 4 | digits[1],
+        digits[2] << 4 | digits[3],
+        digits[4] << 4 | digits[5]
+    );
+    if ( length == 8 )
+        color.setAlpha(digits[6] << 4 | digits[7]);
+    return color;
+}
+
+void skip_space(const QChar*& it, const QChar* end)
+{
+    while ( it != end && it->isSpace() )
+        ++it;
+}
+
+/**
+ * \brief Parses rgb(r,g,b) or, if \p alpha, rgb[a](r,g,b,a)
+ *
+ * Components that overflow an int are read as 0, like QString::toInt() does.
+ */
+QColor parse_function(const QChar* it, const QChar* end, bool alpha)
+{
+    static const char prefix[] = "rgb";
+    for ( const char* p = prefix; *p; ++p, ++it )
+        if ( it == end || *it != QLatin1Char(*p) )
+            return QColor();
+
+    bool has_a = it != end && *it == QLatin1Char('a');
+    if ( has_a )
+    {
+        if ( !alpha )
+            return QColor();
+        ++it;
+    }
+
+    skip_space(it, end);
+    if ( it == end || *it != QLatin1Char('(') )
+        return QColor();
+    ++it;
+
+    int values[4];
+    int count = 0;
+    while ( true )
+    {
+        if ( count == 4 )
+            return QColor();
+
+        skip_space(it, end);
+        qint64 value = 0;
+        const QChar* digits = it;
+        while ( it != end && it->unicode() >= '0' && it->unicode() <= '9' )
+        {
+            if ( value <= std::numeric_limits<int>::max() )
+                value = value * 10 + (it->unicode() - '0');
+            ++it;
+        }
+        if ( it == digits )
+            return QColor();
+        values[count++] = value > std::numeric_limits<int>::max() ? 0 : int(value);
+
+        skip_space(it, end);
+        if ( it == end )
+            return QColor();
+        if ( *it == QLatin1Char(')') )
+            break;
+        if ( *it != QLatin1Char(',') )
+            return QColor();
+        ++it;
+    }
+
+    if ( ++it != end )
+        return QColor();
+
+    if ( count == 3 && !has_a )
+        return QColor(values[0], values[1], values[2]);
+    if ( count == 4 && alpha )
+        return QColor(values[0], values[1], values[2], values[3]);
+    return QColor();
+}
+
+/**
+ * \brief CSS color keyword
+ */
+struct NamedColor
+{
+    const char* name;
+    QRgb        rgba;
+};
+
+/*
+ * CSS named colors in alphabetical order, followed by transparent.
+ * X11 names that differ from CSS (eg: gray, green, maroon, purple) aren't
+ * included, as the same name can't map to two colors.
+ *
+ * name_seeds and name_slots are a perfect hash over the names (hash and
+ * displace): the FNV-1a hash of a name picks a seed in name_seeds, the
+ * FNV-1a hash of the name starting from that seed picks a slot in name_slots,
+ * which holds the index of the name in named_colors plus one.
+ * When changing the names, regenerate both tables with
+ * tools/color_name_hash.py so no two names share a slot.
+ * Ties in nearestColorName() go to the first name, so gray comes before grey.
+ */
+const NamedColor named_colors[] = {
+    {"aliceblue", 0xfff0f8ff},
+    {"antiquewhite", 0xfffaebd7},
+    {"aqua", 0xff00ffff},
+    {"aquamarine", 0xff7fffd4},
+    {"azure", 0xfff0ffff},
+    {"beige", 0xfff5f5dc},
+    {"bisque", 0xffffe4c4},
+    {"black", 0xff000000},
+    {"blanchedalmond", 0xffffebcd},
+    {"blue", 0xff0000ff},
+    {"blueviolet", 0xff8a2be2},
+    {"brown", 0xffa52a2a},
+    {"burlywood", 0xffdeb887},
+    {"cadetblue", 0xff5f9ea0},
+    {"chartreuse", 0xff7fff00},
+    {"chocolate", 0xffd2691e},
+    {"coral", 0xffff7f50},
+    {"cornflowerblue", 0xff6495ed},
+    {"cornsilk", 0xfffff8dc},
+    {"crimson", 0xffdc143c},
+    {"cyan", 0xff00ffff},
+    {"darkblue", 0xff00008b},
+    {"darkcyan", 0xff008b8b},
+    {"darkgoldenrod", 0xffb8860b},
+    {"darkgray", 0xffa9a9a9},
+    {"darkgreen", 0xff006400},
+    {"darkgrey", 0xffa9a9a9},
+    {"darkkhaki", 0xffbdb76b},
+    {"darkmagenta", 0xff8b008b},
+    {"darkolivegreen", 0xff556b2f},
+    {"darkorange", 0xffff8c00},
+    {"darkorchid", 0xff9932cc},
+    {"darkred", 0xff8b0000},
+    {"darksalmon", 0xffe9967a},
+    {"darkseagreen", 0xff8fbc8f},
+    {"darkslateblue", 0xff483d8b},
+    {"darkslategray", 0xff2f4f4f},
+    {"darkslategrey", 0xff2f4f4f},
+    {"darkturquoise", 0xff00ced1},
+    {"darkviolet", 0xff9400d3},
+    {"deeppink", 0xffff1493},
+    {"deepskyblue", 0xff00bfff},
+    {"dimgray", 0xff696969},
+    {"dimgrey", 0xff696969},
+    {"dodgerblue", 0xff1e90ff},
+    {"firebrick", 0xffb22222},
+    {"floralwhite", 0xfffffaf0},
+    {"forestgreen", 0xff228b22},
+    {"fuchsia", 0xffff00ff},
+    {"gainsboro", 0xffdcdcdc},
+    {"ghostwhite", 0xfff8f8ff},
+    {"gold", 0xffffd700},
+    {"goldenrod", 0xffdaa520},
+    {"gray", 0xff808080},
+    {"green", 0xff008000},
+    {"greenyellow", 0xffadff2f},
+    {"grey", 0xff808080},
+    {"honeydew", 0xfff0fff0},
+    {"hotpink", 0xffff69b4},
+    {"indianred", 0xffcd5c5c},
+    {"indigo", 0xff4b0082},
+    {"ivory", 0xfffffff0},
+    {"khaki", 0xfff0e68c},
+    {"lavender", 0xffe6e6fa},
+    {"lavenderblush", 0xfffff0f5},
+    {"lawngreen", 0xff7cfc00},
+    {"lemonchiffon", 0xfffffacd},
+    {"lightblue", 0xffadd8e6},
+    {"lightcoral", 0xfff08080},
+    {"lightcyan", 0xffe0ffff},
+    {"lightgoldenrodyellow", 0xfffafad2},
+    {"lightgray", 0xffd3d3d3},
+    {"lightgreen", 0xff90ee90},
+    {"lightgrey", 0xffd3d3d3},
+    {"lightpink", 0xffffb6c1},
+    {"lightsalmon", 0xffffa07a},
+    {"lightseagreen", 0xff20b2aa},
+    {"lightskyblue", 0xff87cefa},
+    {"lightslategray", 0xff778899},
+    {"lightslategrey", 0xff778899},
+    {"lightsteelblue", 0xffb0c4de},
+    {"lightyellow", 0xffffffe0},
+    {"lime", 0xff00ff00},
+    {"limegreen", 0xff32cd32},
+    {"linen", 0xfffaf0e6},
+    {"magenta", 0xffff00ff},
+    {"maroon", 0xff800000},
+    {"mediumaquamarine", 0xff66cdaa},
+    {"mediumblue", 0xff0000cd},
+    {"mediumorchid", 0xffba55d3},
+    {"mediumpurple", 0xff9370db},
+    {"mediumseagreen", 0xff3cb371},
+    {"mediumslateblue", 0xff7b68ee},
+    {"mediumspringgreen", 0xff00fa9a},
+    {"mediumturquoise", 0xff48d1cc},
+    {"mediumvioletred", 0xffc71585},
+    {"midnightblue", 0xff191970},
+    {"mintcream", 0xfff5fffa},
+    {"mistyrose", 0xffffe4e1},
+    {"moccasin", 0xffffe4b5},
+    {"navajowhite", 0xffffdead},
+    {"navy", 0xff000080},
+    {"oldlace", 0xfffdf5e6},
+    {"olive", 0xff808000},
+    {"olivedrab", 0xff6b8e23},
+    {"orange", 0xffffa500},
+    {"orangered", 0xffff4500},
+    {"orchid", 0xffda70d6},
+    {"palegoldenrod", 0xffeee8aa},
+    {"palegreen", 0xff98fb98},
+    {"paleturquoise", 0xffafeeee},
+    {"palevioletred", 0xffdb7093},
+    {"papayawhip", 0xffffefd5},
+    {"peachpuff", 0xffffdab9},
+    {"peru", 0xffcd853f},
+    {"pink", 0xffffc0cb},
+    {"plum", 0xffdda0dd},
+    {"powderblue", 0xffb0e0e6},
+    {"purple", 0xff800080},
+    {"rebeccapurple", 0xff663399},
+    {"red", 0xffff0000},
+    {"rosybrown", 0xffbc8f8f},
+    {"royalblue", 0xff4169e1},
+    {"saddlebrown", 0xff8b4513},
+    {"salmon", 0xfffa8072},
+    {"sandybrown", 0xfff4a460},
+    {"seagreen", 0xff2e8b57},
+    {"seashell", 0xfffff5ee},
+    {"sienna", 0xffa0522d},
+    {"silver", 0xffc0c0c0},
+    {"skyblue", 0xff87ceeb},
+    {"slateblue", 0xff6a5acd},
+    {"slategray", 0xff708090},
+    {"slategrey", 0xff708090},
+    {"snow", 0xfffffafa},
+    {"springgreen", 0xff00ff7f},
+    {"steelblue", 0xff4682b4},
+    {"tan", 0xffd2b48c},
+    {"teal", 0xff008080},
+    {"thistle", 0xffd8bfd8},
+    {"tomato", 0xffff6347},
+    {"turquoise", 0xff40e0d0},
+    {"violet", 0xffee82ee},
+    {"wheat", 0xfff5deb3},
+    {"white", 0xffffffff},
+    {"whitesmoke", 0xfff5f5f5},
+    {"yellow", 0xffffff00},
+    {"yellowgreen", 0xff9acd32},
+    {"transparent", 0x00000000},
+};
+
+const quint8 name_seeds[64] = {
+      0,   0,   0,   6,   1,   0,   0,   0,   2,   1,   2,   0,   2,   1,   2,   2,
+      0,   1,   0,   2,   2,   3,   0,   0,   4,   2,   1,   0,   2,   1,   1,   3,
+      3,   0,   1,   0,   3,   0,   1,   2,   1,   2,   0,   1,   0,   2,   1,   3,
+      0,   3,   1,   3,   8,   1,   1,   3,   0,   5,   1,   0,   1,   0,   1,   6,
+};
+
+const quint8 name_slots[256] = {
+      0, 119,   0,  27, 146,   0,  69, 135,  85,  95,  53,   0,   0,  49, 140,   0,
+     35,   0,   0,  81,  22,   0,  33, 136,  11,   0,   0,   0,   0,  83, 112, 116,
+      0,  67,  63,   0,   0,   0,   0,   0, 133,  39,   0,  56,  34,  44,   0,  16,
+     78, 122,   0,   0,   0,  46,   0,  45,   0, 124, 104,  68,   0,   0,  88,   0,
+      0,   8,   0,   0,   0,  76,   0,   0, 131,   0,  60, 109,   0,   0,  92,   7,
+      0, 145,  17,  64,   0, 142, 117,   4,   0,   0,   0, 134, 139,   0,  70,  57,
+     82,   0, 148,   0, 111,   0,   0, 120, 102,   0, 126,  54, 123,  71,   0,   0,
+     42,  62,  12,   0,  89,   0,  18, 128,   0, 100,   9,  86,   0,   0,   0,   0,
+     41, 132,   6,  32,  59,  52, 110,   0,  10,   0,   0,   0,  30,   0,  75,  23,
+    144,   5,  99,   0,  37, 107,  66,  91,   0,   0,  61,  26,   0,   0,   0,   0,
+      0,  20, 114,   0, 127,  94, 137, 113, 149,  14,   0,   0,  98,  93, 121,  13,
+     96, 101,  31,   0,  97,   0,  65,   0,   0,  79,   0,   0,   0, 105, 106,  29,
+      0,   0,   0,  38, 147,   0,  73,   0,   0,   2, 103,   0,  15,  36,   0, 143,
+     80,   0,   0,  21,  58, 115,  28,  72, 125,   0,   0,  40,  47,   0,   0,   0,
+     77, 141,   0,  90,   0, 118,   0,   0,   0,   0,  19,   0, 138,   1, 129,  55,
+      0,  43,  74, 130,   0,  48,  24,  25,   0,  84,   0,  50,  87,  51,   3, 108,
+};
+
+const int named_color_count = sizeof(named_colors) / sizeof(named_colors[0]);
+
+quint32 name_hash(const char* name, int length, quint32 seed)
+{
+    quint32 hash = 2166136261u ^ seed;
+    for ( int i = 0; i < length; i++ )
+    {
+        hash ^= quint8(name[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * \brief Finds the entry for a lowercase name
+ * \returns \c nullptr if \p name isn't a color name
+ */
+const NamedColor* find_named_color(const char* name, int length)
+{
+    quint32 seed = name_seeds[name_hash(name, length, 0) % sizeof(name_seeds)];
+    int slot = name_slots[name_hash(name, length, seed) % sizeof(name_slots)];
+    if ( !slot )
+        return nullptr;
+
+    const NamedColor* color = named_colors + slot - 1;
+    if ( std::strncmp(color->name, name, length) != 0 || color->name[length] )
+        return nullptr;
+    return color;
+}
+
+/**
+ * \brief Index of the named colors, excluding transparent
+ */
+const detail::NearestColorIndex& named_color_index()
+{
+    static const detail::NearestColorIndex index = []{
+        QVector<QRgb> colors;
+        colors.reserve(named_color_count - 1);
+        for ( int i = 0; i < named_color_count; i++ )
+            if ( qAlpha(named_colors[i].rgba) == 255 )
+                colors.push_back(named_colors[i].rgba);
+        detail::NearestColorIndex index;
+        index.build(colors);
+        return index;
+    }();
+    return index;
+}
+
+/**
+ * \brief Looks up a color name made of letters only, case insensitive
+ */
+QColor parse_name(const QChar* begin, const QChar* end)
+{
+    // Longer than any named color
+    static const int max_length = 32;
+    char name[max_length];
+    int length = end - begin;
+    if ( length > max_length )
+        return QColor();
+
+    for ( int i = 0; i < length; i++ )
+    {
+        // Non-ASCII letters can't be part of a color name
+        if ( !begin[i].isLetter() || begin[i].unicode() >= 0x80 )
+            return QColor();
+        name[i] = char(begin[i].unicode() | 0x20);
+    }
+
+    const NamedColor* color = find_named_color(name, length);
+    return color ? QColor::fromRgba(color->rgba) : QColor();
+}
+
+/**
+ * \brief Single pass equivalent of the accepted formats listed for colorFromString()
+ */
+QColor parse_color(const QChar* begin, const QChar* end, bool alpha)
+{
+    skip_space(begin, end);
+    while ( end != begin && (end - 1)->isSpace() )
+        --end;
+
+    if ( begin == end )
+        return QColor();
+
+    if ( *begin == QLatin1Char('#') )
+        return parse_hex(begin + 1, end, alpha);
+
+    if ( *begin == QLatin1Char('r') )
+    {
+        QColor color = parse_function(begin, end, alpha);
+        if ( color.isValid() )
+            return color;
+    }
+
+    return parse_name(begin, end);
+}
+
+bool is_word_char(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_') || c == QLatin1Char('-');
+}
+
+const QChar* skip_word(const QChar* it, const QChar* end)
+{
+    while ( it != end && is_word_char(*it) )
+        ++it;
+    return it;
+}
+
+/**
+ * \brief Parses a hex number with no \c #, with an optional 0x prefix
+ */
+QColor parse_hex_number(const QChar* begin, const QChar* end, bool alpha)
+{
+    bool prefixed = end - begin > 2 && *begin == QLatin1Char('0') &&
+                    (begin[1] == QLatin1Char('x') || begin[1] == QLatin1Char('X'));
+    if ( !prefixed )
+    {
+        if ( end - begin != 6 && end - begin != 8 )
+            return QColor();
+        return parse_hex(begin, end, alpha);
+    }
+
+    begin += 2;
+    int length = end - begin;
+    if ( length != 6 && !(alpha && length == 8) )
+        return QColor();
+
+    quint32 value = 0;
+    for ( const QChar* it = begin; it != end; ++it )
+    {
+        int digit = hex_digit(*it);
+        if ( digit < 0 )
+            return QColor();
+        value = value << 4 | digit;
+    }
+
+    if ( length == 6 )
+        return QColor(QRgb(value | 0xff000000u));
+    return QColor::fromRgba(value);
+}
+
+/**
+ * \brief Finds the end of the argument list of an rgb() function
+ * \returns The position after the closing parenthesis, or \c nullptr
+ */
+const QChar* function_end(const QChar* it, const QChar* end)
+{
+    // Longer than any valid argument list, so garbage doesn't get scanned to the end
+    static const int max_length = 64;
+
+    while ( it != end && it->isSpace() )
+        ++it;
+    if ( it == end || *it != QLatin1Char('(') )
+        return nullptr;
+
+    const QChar* limit = end - it > max_length ? it + max_length : end;
+    for ( ; it != limit; ++it )
+        if ( *it == QLatin1Char(')') )
+            return it + 1;
+    return nullptr;
+}
+
+void write_hex(QChar*& out, int value)
+{
+    static const char digits[] = "0123456789abcdef";
+    *out++ = QLatin1Char(digits[(value >> 4) & 0xf]);
+    *out++ = QLatin1Char(digits[value & 0xf]);
+}
+
+/**
+ * \brief Writes a non-negative integer up to 999
+ */
+void write_decimal(QChar*& out, int value)
+{
+    if ( value >= 100 )
+        *out++ = QLatin1Char('0' + value / 100);
+    if ( value >= 10 )
+        *out++ = QLatin1Char('0' + value / 10 % 10);
+    *out++ = QLatin1Char('0' + value % 10);
+}
+
+/**
+ * \brief Writes alpha below 255 as a fraction in [0-1] with up to 3 decimals
+ */
+void write_alpha_fraction(QChar*& out, int alpha)
+{
+    int thousandths = qRound(alpha * 1000 / 255.0);
+    *out++ = QLatin1Char('0');
+    if ( !thousandths )
+        return;
+    *out++ = QLatin1Char('.');
+    for ( int unit = 100; thousandths; unit /= 10 )
+    {
+        *out++ = QLatin1Char('0' + thousandths / unit);
+        thousandths %= unit;
+    }
+}
+
+void write_latin1(QChar*& out, const char* string)
+{
+    while ( *string )
+        *out++ = QLatin1Char(*string++);
+}
+
+} // namespace
 
 QString stringFromColor(const QColor& color, bool alpha)
 {
-    if ( !alpha || color.alpha() == 255 )
-        return color.name();
-    return color.name()+QStringLiteral("%1").arg(color.alpha(), 2, 16, QChar('0'));
+    QChar buffer[max_color_string_length];
+    return QString(buffer, formatColor(color, buffer, HexString, alpha));
 }
 
-QColor colorFromString(const QString& string, bool alpha)
+int formatColor(const QColor& color, QChar* buffer, ColorStringFormat format, bool alpha)
 {
-    QString xs = string.trimmed();
-    QRegularExpressionMatch match;
+    QChar* out = buffer;
+    bool write_alpha = alpha && color.alpha() != 255;
 
-    match = regex_qcolor.match(xs);
-    if ( match.hasMatch() )
+    if ( format == HexString )
     {
-        return QColor(xs);
+        QRgb rgb = color.rgba();
+        *out++ = QLatin1Char('#');
+        write_hex(out, qRed(rgb));
+        write_hex(out, qGreen(rgb));
+        write_hex(out, qBlue(rgb));
+        if ( write_alpha )
+            write_hex(out, qAlpha(rgb));
+        return out - buffer;
     }
 
-    match = regex_func_rgb.match(xs);
-    if ( match.hasMatch() )
+    int components[3];
+    if ( format == HslString )
     {
-        return QColor(
-            match.captured(1).toInt(),
-            match.captured(2).toInt(),
-            match.captured(3).toInt()
-        );
+        QColor hsl = color.toHsl();
+        components[0] = qMax(hsl.hslHue(), 0);
+        components[1] = qRound(hsl.hslSaturation() * 100 / 255.0);
+        components[2] = qRound(hsl.lightness() * 100 / 255.0);
+        write_latin1(out, write_alpha ? "hsla(" : "hsl(");
+    }
+    else
+    {
+        QRgb rgb = color.rgba();
+        components[0] = qRed(rgb);
+        components[1] = qGreen(rgb);
+        components[2] = qBlue(rgb);
+        write_latin1(out, write_alpha ? "rgba(" : "rgb(");
+    }
+
+    for ( int i = 0; i < 3; i++ )
+    {
+        if ( i )
+            *out++ = QLatin1Char(',');
+        write_decimal(out, components[i]);
+        if ( i && format == HslString )
+            *out++ = QLatin1Char('%');
     }
 
-    if ( alpha )
+    if ( write_alpha )
     {
-        match = regex_hex_rgba.match(xs);
-        if ( match.hasMatch() )
+        *out++ = QLatin1Char(',');
+        // CSS hsla() only takes alpha as a fraction
+        if ( format == HslString )
+            write_alpha_fraction(out, color.alpha());
+        else
+            write_decimal(out, color.alpha());
+    }
+    *out++ = QLatin1Char(')');
+    return out - buffer;
+}
+
+void appendColorString(QString& string, const QColor& color,
+                       ColorStringFormat format, bool alpha)
+{
+    QChar buffer[max_color_string_length];
+    string.append(buffer, formatColor(color, buffer, format, alpha));
+}
+
+QString formatColors(const QVector<QColor>& colors, ColorStringFormat format,
+                     bool alpha, QChar separator)
+{
+    if ( colors.isEmpty() )
+        return QString();
+
+    // Write straight into the result, then trim to the actual length
+    QString string(colors.size() * (max_color_string_length + 1), Qt::Uninitialized);
+    QChar* begin = string.data();
+    QChar* out = begin;
+    for ( const QColor& color : colors )
+    {
+        if ( out != begin )
+            *out++ = separator;
+        out += formatColor(color, out, format, alpha);
+    }
+    string.truncate(out - begin);
+    return string;
+}
+
+QColor colorFromString(const QString& string, bool alpha)
+{
+    return parse_color(string.constData(), string.constData() + string.size(), alpha);
+}
+
+QColor colorFromName(const QString& name)
+{
+    return parse_name(name.constData(), name.constData() + name.size());
+}
+
+QString nearestColorName(const QColor& color, qreal* distance)
+{
+    float match_distance = 0;
+    int index = named_color_index().nearest(color.rgb(), &match_distance);
+    if ( distance )
+        *distance = match_distance;
+    return QString::fromLatin1(named_colors[index].name);
+}
+
+QVector<ColorMatch> findColors(const QChar* text, int length,
+                               ColorTextFormat format, bool alpha)
+{
+    QVector<ColorMatch> found;
+    const QChar* const end = text + length;
+    const bool css = format != HexColorText;
+    const bool hex_numbers = format != CssColorText;
+
+    auto add = [&found, text](const QColor& color, const QChar* begin, const QChar* end) {
+        found.push_back(ColorMatch{color, int(begin - text), int(end - begin)});
+    };
+
+    const QChar* it = text;
+    while ( it != end )
+    {
+        if ( *it == QLatin1Char('#') )
+        {
+            const QChar* word_end = skip_word(it + 1, end);
+            QColor color = parse_hex(it + 1, word_end, alpha);
+            if ( color.isValid() )
+                add(color, it, word_end);
+            it = word_end;
+            continue;
+        }
+
+        if ( !is_word_char(*it) )
         {
-            return QColor(
-                xs.mid(1,2).toInt(nullptr,16),
-                xs.mid(3,2).toInt(nullptr,16),
-                xs.mid(5,2).toInt(nullptr,16),
-                xs.mid(7,2).toInt(nullptr,16)
-            );
+            ++it;
+            continue;
         }
 
-        match = regex_func_rgba.match(xs);
-        if ( match.hasMatch() )
+        const QChar* word_begin = it;
+        const QChar* word_end = skip_word(it, end);
+        it = word_end;
+
+        QChar first = *word_begin;
+        if ( hex_numbers && hex_digit(first) >= 0 )
+        {
+            QColor color = parse_hex_number(word_begin, word_end, alpha);
+            if ( color.isValid() )
+            {
+                add(color, word_begin, word_end);
+                continue;
+            }
+        }
+
+        if ( css && first == QLatin1Char('r') && (word_end - word_begin == 3 || word_end - word_begin == 4) )
         {
-            return QColor(
-                match.captured(1).toInt(),
-                match.captured(2).toInt(),
-                match.captured(3).toInt(),
-                match.captured(4).toInt()
-            );
+            if ( const QChar* args_end = function_end(word_end, end) )
+            {
+                QColor color = parse_function(word_begin, args_end, alpha);
+                if ( color.isValid() )
+                {
+                    add(color, word_begin, args_end);
+                    it = args_end;
+                    continue;
+                }
+            }
+        }
+
+        if ( css && first.isLetter() )
+        {
+            QColor color = parse_name(word_begin, word_end);
+            if ( color.isValid() )
+                add(color, word_begin, word_end);
         }
     }
 
-    return QColor();
+    return found;
+}
+
+QVector<ColorMatch> findColors(const QString& text, ColorTextFormat format, bool alpha)
+{
+    return findColors(text.constData(), text.size(), format, alpha);
 }
 
 } // namespace color_widgets
@@ -20,15 +20,160 @@
  *
  */
 #include "color_palette.hpp"
+#include <algorithm>
 #include <cmath>
 #include <QFile>
 #include <QTextStream>
 #include <QHash>
 #include <QPainter>
 #include <QFileInfo>
+#include <vector>
+#include "color_quantization.hpp"
+#include "nearest_color.hpp"
 
 namespace color_widgets {
 
+namespace {
+
+/**
+ * \brief Open addressing hash set of opaque QRgb values
+ *
+ * Empty slots are marked with 0, which is never an opaque color
+ */
+class OpaqueRgbSet
+{
+public:
+    OpaqueRgbSet()
+        : slots(1024, 0), mask(1023), size(0)
+    {}
+
+    /**
+     * \brief Inserts an opaque color
+     * \returns \b false if \p rgb was already in the set
+     */
+    bool insert(QRgb rgb)
+    {
+        quint32 index = hash(rgb) & mask;
+        while ( slots[index] )
+        {
+            if ( slots[index] == rgb )
+                return false;
+            index = (index + 1) & mask;
+        }
+
+        slots[index] = rgb;
+        if ( ++size * 2 > int(slots.size()) )
+            grow();
+        return true;
+    }
+
+private:
+    static quint32 hash(QRgb rgb)
+    {
+        return (rgb * 0x9E3779B1u) >> 8;
+    }
+
+    void grow()
+    {
+        std::vector<QRgb> old(slots.size() * 2, 0);
+        old.swap(slots);
+        mask = slots.size() - 1;
+        for ( QRgb rgb : old )
+        {
+            if ( !rgb )
+                continue;
+            quint32 index = hash(rgb) & mask;
+            while ( slots[index] )
+                index = (index + 1) & mask;
+            slots[index] = rgb;
+        }
+    }
+
+    std::vector<QRgb> slots;
+    quint32 mask;
+    int size;
+};
+
+/**
+ * \brief Index along a 3D Hilbert curve (Skilling's algorithm)
+ * \param coords Coordinates in [0, 2^bits), modified in place
+ */
+quint32 hilbert_index(quint32 coords[3], int bits)
+{
+    quint32 high = 1u << (bits - 1);
+
+    for ( quint32 q = high; q > 1; q >>= 1 )
+    {
+        quint32 mask = q - 1;
+        for ( int i = 0; i < 3; i++ )
+        {
+            if ( coords[i] & q )
+            {
+                coords[0] ^= mask;
+            }
+            else
+            {
+                quint32 swap = (coords[0] ^ coords[i]) & mask;
+                coords[0] ^= swap;
+                coords[i] ^= swap;
+            }
+        }
+    }
+
+    for ( int i = 1; i < 3; i++ )
+        coords[i] ^= coords[i-1];
+    quint32 gray = 0;
+    for ( quint32 q = high; q > 1; q >>= 1 )
+        if ( coords[2] & q )
+            gray ^= q - 1;
+    for ( int i = 0; i < 3; i++ )
+        coords[i] ^= gray;
+
+    quint32 index = 0;
+    for ( int bit = bits - 1; bit >= 0; bit-- )
+        for ( int i = 0; i < 3; i++ )
+            index = (index << 1) | ((coords[i] >> bit) & 1);
+    return index;
+}
+
+/**
+ * \brief Precomputed sort key for a palette entry
+ */
+struct EntryKey
+{
+    double primary;
+    double secondary;
+    int index;
+};
+
+EntryKey entry_key(const QColor& color, int index, ColorPalette::SortKey key)
+{
+    QRgb rgb = color.rgb();
+    switch ( key )
+    {
+        case ColorPalette::SortByHue:
+            return EntryKey{color.hsvHueF(), detail::rgb_to_cielab(rgb).l, index};
+        case ColorPalette::SortByLuminance:
+            return EntryKey{detail::rgb_to_cielab(rgb).l, 0, index};
+        case ColorPalette::SortPerceptual:
+        default:
+        {
+            static const int bits = 10;
+            static const float scale = (1 << bits) - 1;
+            detail::Oklab lab = detail::rgb_to_oklab(rgb);
+            // Same scale on all axes, a and b are well within [-0.5, 0.5]
+            quint32 coords[3] = {
+                quint32(qBound(0.f, lab.l, 1.f) * scale),
+                quint32(qBound(0.f, lab.a + 0.5f, 1.f) * scale),
+                quint32(qBound(0.f, lab.b + 0.5f, 1.f) * scale),
+            };
+            return EntryKey{double(hilbert_index(coords, bits)), 0, index};
+        }
+    }
+}
+
+} // namespace
+
 class ColorPalette::Private
 {
 public:
@@ -37,11 +182,63 @@ public:
     QString         name;
     QString         fileName;
     bool            dirty;
+    detail::NearestColorIndex nearest;
+    bool            nearest_dirty = true;
 
     bool valid_index(int index)
     {
         return index >= 0 && index < colors.size();
     }
+
+    /**
+     * \brief Replaces the colors with opaque versions of \p values
+     * \param unique Whether to skip colors already found earlier in \p values
+     */
+    void load_rgb(const QRgb* values, int count, bool unique)
+    {
+        colors.clear();
+
+        if ( !unique )
+        {
+            colors.reserve(count);
+            for ( int i = 0; i < count; i++ )
+                colors.push_back(qMakePair(QColor(values[i]), QString()));
+            return;
+        }
+
+        // kept is 4 bytes per value, reserving for the worst case avoids
+        // growing it while colors is sized exactly once below
+        OpaqueRgbSet seen;
+        QVector<QRgb> kept;
+        kept.reserve(count);
+        for ( int i = 0; i < count; i++ )
+        {
+            QRgb rgb = values[i] | 0xff000000u;
+            if ( seen.insert(rgb) )
+                kept.push_back(rgb);
+        }
+
+        colors.reserve(kept.size());
+        for ( QRgb rgb : kept )
+            colors.push_back(qMakePair(QColor(rgb), QString()));
+    }
+
+    /**
+     * \brief Nearest color lookup, rebuilt if the colors have changed
+     */
+    const detail::NearestColorIndex& nearest_index()
+    {
+        if ( nearest_dirty )
+        {
+            QVector<QRgb> table;
+            table.reserve(colors.size());
+            for ( const auto& color : colors )
+                table.push_back(color.first.rgb());
+            nearest.build(table);
+            nearest_dirty = false;
+        }
+        return nearest;
+    }
 };
 
 ColorPalette::ColorPalette(const QVector<QColor>& colors,
@@ -140,46 +337,60 @@ QString ColorPalette::name() const
     return p->name;
 }
 
-void ColorPalette::loadColorTable(const QVector<QRgb>& color_table)
+void ColorPalette::loadColorTable(const QVector<QRgb>& color_table, bool unique)
 {
-    p->colors.clear();
-    p->colors.reserve(color_table.size());
-    for ( QRgb c : color_table )
-    {
-        QColor color ( c );
-        color.setAlpha(255);
-        p->colors.push_back(qMakePair(color,QString()));
-    }
+    p->load_rgb(color_table.constData(), color_table.size(), unique);
+    p->nearest_dirty = true;
     Q_EMIT colorsChanged(p->colors);
     setDirty(true);
 }
 
-bool ColorPalette::loadImage(const QImage& image)
+bool ColorPalette::loadImage(const QImage& image, bool unique)
 {
     if ( image.isNull() )
         return false;
-    setColumns(image.width());
+    setColumns(unique ? 0 : image.width());
 
+    // 32 bit scanlines have no padding so the pixels are contiguous
+    QImage rgb_image = image.convertToFormat(QImage::Format_RGB32);
+    p->load_rgb(reinterpret_cast<const QRgb*>(rgb_image.constBits()),
+                rgb_image.width() * rgb_image.height(), unique);
+    p->nearest_dirty = true;
+    Q_EMIT colorsChanged(p->colors);
+    setDirty(true);
+    return true;
+}
+
+bool ColorPalette::loadImage(const QImage& image, QuantizationMethod method,
+                             int max_colors, QuantizationSpace space)
+{
+    if ( image.isNull() )
+        return false;
+    setColumns(0);
+
+    QVector<QColor> colors = detail::quantize_image(image, max_colors, method, space);
     p->colors.clear();
-    p->colors.reserve(image.width()*image.height());
-    for ( int y = 0; y < image.height(); y++ )
-    {
-        for ( int x = 0; x < image.width(); x++ )
-        {
-            QColor color ( image.pixel(x, y) );
-            color.setAlpha(255);
-            p->colors.push_back(qMakePair(color,QString()));
-        }
-    }
+    p->colors.reserve(colors.size());
+    for ( const QColor& color : colors )
+        p->colors.push_back(qMakePair(color,QString()));
+    p->nearest_dirty = true;
     Q_EMIT colorsChanged(p->colors);
     setDirty(true);
     return true;
 }
 
-ColorPalette ColorPalette::fromImage(const QImage& image)
+ColorPalette ColorPalette::fromImage(const QImage& image, bool unique)
+{
+    ColorPalette p;
+    p.loadImage(image, unique);
+    return p;
+}
+
+ColorPalette ColorPalette::fromImage(const QImage& image, QuantizationMethod method,
+                                     int max_colors, QuantizationSpace space)
 {
     ColorPalette p;
-    p.loadImage(image);
+    p.loadImage(image, method, max_colors, space);
     return p;
 }
 
@@ -249,6 +460,7 @@ bool ColorPalette::load(const QString& name)
         p->colors.push_back(qMakePair(QColor(r, g, b), line));
     }
 
+    p->nearest_dirty = true;
     Q_EMIT colorsChanged(p->colors);
     setDirty(false);
 
@@ -330,6 +542,7 @@ void ColorPalette::setColors(const QVector<QColor>& colors)
     p->colors.clear();
     Q_FOREACH(const QColor& col, colors)
         p->colors.push_back(qMakePair(col,QString()));
+    p->nearest_dirty = true;
     setDirty(true);
     Q_EMIT colorsChanged(p->colors);
 }
@@ -337,6 +550,7 @@ void ColorPalette::setColors(const QVector<QColor>& colors)
 void ColorPalette::setColors(const QVector<QPair<QColor,QString> >& colors)
 {
     p->colors = colors;
+    p->nearest_dirty = true;
     setDirty(true);
     Q_EMIT colorsChanged(p->colors);
 }
@@ -349,6 +563,7 @@ void ColorPalette::setColorAt(int index, const QColor& color)
 
     p->colors[index].first = color;
 
+    p->nearest_dirty = true;
     setDirty(true);
     Q_EMIT colorChanged(index);
     Q_EMIT colorsUpdated(p->colors);
@@ -361,6 +576,7 @@ void ColorPalette::setColorAt(int index, const QColor& color, const QString& nam
 
     p->colors[index].first = color;
     p->colors[index].second = name;
+    p->nearest_dirty = true;
     setDirty(true);
     Q_EMIT colorChanged(index);
     Q_EMIT colorsUpdated(p->colors);
@@ -382,11 +598,44 @@ void ColorPalette::setNameAt(int index, const QString& name)
 void ColorPalette::appendColor(const QColor& color, const QString& name)
 {
     p->colors.push_back(qMakePair(color,name));
+    p->nearest_dirty = true;
     setDirty(true);
     Q_EMIT colorAdded(p->colors.size()-1);
     Q_EMIT colorsUpdated(p->colors);
 }
 
+void ColorPalette::appendColors(const QVector<QColor>& colors)
+{
+    if ( colors.empty() )
+        return;
+
+    p->colors.reserve(p->colors.size() + colors.size());
+    for ( const QColor& color : colors )
+        p->colors.push_back(qMakePair(color, QString()));
+    p->nearest_dirty = true;
+    setDirty(true);
+    Q_EMIT colorsChanged(p->colors);
+}
+
+int ColorPalette::importText(const QString& text, ColorTextFormat format)
+{
+    QVector<ColorMatch> matches = findColors(text, format);
+    QVector<QColor> colors;
+    colors.reserve(matches.size());
+    for ( const ColorMatch& match : matches )
+        colors.push_back(match.color);
+    appendColors(colors);
+    return colors.size();
+}
+
+int ColorPalette::importFile(const QString& filename, ColorTextFormat format)
+{
+    QFile file(filename);
+    if ( !file.open(QFile::ReadOnly|QFile::Text) )
+        return -1;
+    return importText(QString::fromUtf8(file.readAll()), format);
+}
+
 void ColorPalette::insertColor(int index, const QColor& color, const QString& name)
 {
     if ( index < 0 || index > p->colors.size() )
@@ -394,6 +643,7 @@ void ColorPalette::insertColor(int index, const QColor& color, const QString& na
 
     p->colors.insert(index, qMakePair(color, name));
 
+    p->nearest_dirty = true;
     setDirty(true);
     Q_EMIT colorAdded(index);
     Q_EMIT colorsUpdated(p->colors);
@@ -406,6 +656,7 @@ void ColorPalette::eraseColor(int index)
 
     p->colors.remove(index);
 
+    p->nearest_dirty = true;
     setDirty(true);
     Q_EMIT colorRemoved(index);
     Q_EMIT colorsUpdated(p->colors);
@@ -488,10 +739,148 @@ QVector<QRgb> ColorPalette::colorTable() const
     return out;
 }
 
-ColorPalette ColorPalette::fromColorTable(const QVector<QRgb>& table)
+int ColorPalette::nearestIndex(const QColor& color, qreal* distance) const
+{
+    float match_distance = 0;
+    int index = p->nearest_index().nearest(color.rgb(), &match_distance);
+    if ( distance )
+        *distance = match_distance;
+    return index;
+}
+
+QVector<int> ColorPalette::nearestIndices(const QVector<QColor>& colors) const
+{
+    QVector<int> out(colors.size(), -1);
+    const detail::NearestColorIndex& index = p->nearest_index();
+    if ( index.empty() )
+        return out;
+
+    int* data = out.data();
+    detail::parallel_for(colors.size(), [&index, &colors, data](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+            data[i] = index.nearest(colors[i].rgb());
+    }, 1024);
+    return out;
+}
+
+QImage ColorPalette::remapImage(const QImage& image, Dithering dithering) const
+{
+    QVector<QRgb> table;
+    table.reserve(p->colors.size());
+    for ( const auto& color : p->colors )
+        table.push_back(color.first.rgb());
+    return detail::remap_image(image, table, p->nearest_index(), dithering);
+}
+
+void ColorPalette::sort(SortKey key, Qt::SortOrder order)
+{
+    const int count = p->colors.size();
+    if ( count < 2 )
+        return;
+
+    QVector<EntryKey> keys(count);
+    EntryKey* data = keys.data();
+    const auto& colors = p->colors;
+    detail::parallel_for(count, [data, &colors, key](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+            data[i] = entry_key(colors[i].first, i, key);
+    }, 1024);
+
+    if ( order == Qt::AscendingOrder )
+        detail::parallel_stable_sort(data, count, [](const EntryKey& a, const EntryKey& b) {
+            return a.primary < b.primary || (a.primary == b.primary && a.secondary < b.secondary);
+        });
+    else
+        detail::parallel_stable_sort(data, count, [](const EntryKey& a, const EntryKey& b) {
+            return a.primary > b.primary || (a.primary == b.primary && a.secondary > b.secondary);
+        });
+
+    QVector<QPair<QColor,QString> > sorted;
+    sorted.reserve(count);
+    for ( const EntryKey& entry : keys )
+        sorted.push_back(p->colors[entry.index]);
+    setColors(sorted);
+}
+
+QVector<int> ColorPalette::cluster(int count) const
+{
+    if ( count <= 0 || p->colors.empty() )
+        return QVector<int>(p->colors.size(), -1);
+
+    QVector<detail::ColorSample> samples(p->colors.size());
+    detail::ColorSample* data = samples.data();
+    const auto& colors = p->colors;
+    detail::parallel_for(samples.size(), [data, &colors](int begin, int end) {
+        for ( int i = begin; i < end; i++ )
+        {
+            QRgb rgb = colors[i].first.rgb();
+            data[i].rgb[0] = qRed(rgb);
+            data[i].rgb[1] = qGreen(rgb);
+            data[i].rgb[2] = qBlue(rgb);
+            data[i].weight = 1;
+            detail::sample_set_position(data[i], QuantizeOklab);
+        }
+    }, 1024);
+
+    QVector<detail::ColorSample> centroids = detail::median_cut(samples, count);
+    QVector<int> assignment = detail::kmeans(samples, centroids);
+
+    // Renumber from darkest to lightest
+    QVector<int> by_lightness(centroids.size());
+    for ( int i = 0; i < by_lightness.size(); i++ )
+        by_lightness[i] = i;
+    std::stable_sort(by_lightness.begin(), by_lightness.end(), [&centroids](int a, int b) {
+        return centroids[a].pos[0] < centroids[b].pos[0];
+    });
+    QVector<int> rank(centroids.size());
+    for ( int i = 0; i < by_lightness.size(); i++ )
+        rank[by_lightness[i]] = i;
+    for ( int& group : assignment )
+        group = rank[group];
+
+    return assignment;
+}
+
+void ColorPalette::groupClusters(int count)
+{
+    QVector<int> groups = cluster(count);
+    if ( groups.empty() || groups[0] == -1 )
+        return;
+
+    QVector<int> order(groups.size());
+    for ( int i = 0; i < order.size(); i++ )
+        order[i] = i;
+    detail::parallel_stable_sort(order.data(), order.size(), [&groups](int a, int b) {
+        return groups[a] < groups[b];
+    });
+
+    QVector<QPair<QColor,QString> > grouped;
+    grouped.reserve(order.size());
+    for ( int index : order )
+        grouped.push_back(p->colors[index]);
+    setColors(grouped);
+}
+
+int ColorPalette::mergeSimilar(qreal threshold, ColorDifference metric)
+{
+    QVector<int> similar = findSimilarColors(onlyColors(), threshold, metric);
+
+    QVector<QPair<QColor,QString> > kept;
+    kept.reserve(similar.size());
+    for ( int i = 0; i < similar.size(); i++ )
+        if ( similar[i] == -1 )
+            kept.push_back(p->colors[i]);
+
+    int removed = p->colors.size() - kept.size();
+    if ( removed )
+        setColors(kept);
+    return removed;
+}
+
+ColorPalette ColorPalette::fromColorTable(const QVector<QRgb>& table, bool unique)
 {
     ColorPalette palette;
-    palette.loadColorTable(table);
+    palette.loadColorTable(table, unique);
     return palette;
 }
 
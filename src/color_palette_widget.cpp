@@ -332,12 +332,24 @@ void ColorPaletteWidget::setReadOnly(bool readOnly)
 bool ColorPaletteWidget::setCurrentColor(const QColor& color)
 {
     const auto& palette = p->swatch->palette();
-    for ( int i = 0; i < palette.count(); i++ )
+    qreal distance = 0;
+    int nearest = palette.nearestIndex(color, &distance);
+    if ( nearest != -1 && palette.colorAt(nearest) == color )
+    {
+        p->swatch->setSelected(nearest);
+        return true;
+    }
+
+    // Same RGB but differing in alpha or spec, fall back to the exact scan
+    if ( nearest != -1 && distance == 0 )
     {
-        if ( palette.colorAt(i) == color )
+        for ( int i = 0; i < palette.count(); i++ )
         {
-            p->swatch->setSelected(i);
-            return true;
+            if ( palette.colorAt(i) == color )
+            {
+                p->swatch->setSelected(i);
+                return true;
+            }
         }
     }
 
@@ -345,6 +357,13 @@ bool ColorPaletteWidget::setCurrentColor(const QColor& color)
     return false;
 }
 
+int ColorPaletteWidget::setNearestColor(const QColor& color)
+{
+    int index = p->swatch->palette().nearestIndex(color);
+    p->swatch->setSelected(index);
+    return index;
+}
+
 bool ColorPaletteWidget::setCurrentColor(const QString& name)
 {
     const auto& palette = p->swatch->palette();
@@ -0,0 +1,739 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "color_quantization.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+#include "color_utils.hpp"
+
+namespace color_widgets {
+namespace detail {
+
+void sample_set_position(ColorSample& sample, ColorPalette::QuantizationSpace space)
+{
+    if ( space == ColorPalette::QuantizeOklab )
+    {
+        // Scaled so the coordinates have about the same magnitude as in RGB
+        Oklab lab = linear_rgb_to_oklab(
+            srgb_to_linear(sample.rgb[0] / 255),
+            srgb_to_linear(sample.rgb[1] / 255),
+            srgb_to_linear(sample.rgb[2] / 255)
+        );
+        sample.pos[0] = lab.l * 255;
+        sample.pos[1] = lab.a * 255;
+        sample.pos[2] = lab.b * 255;
+    }
+    else
+    {
+        sample.pos[0] = sample.rgb[0];
+        sample.pos[1] = sample.rgb[1];
+        sample.pos[2] = sample.rgb[2];
+    }
+}
+
+QVector<ColorSample> image_histogram(const QImage& image,
+                                     ColorPalette::QuantizationSpace space)
+{
+    QImage argb = image;
+    if ( argb.format() != QImage::Format_RGB32 && argb.format() != QImage::Format_ARGB32 )
+        argb = argb.convertToFormat(QImage::Format_ARGB32);
+
+    // For each bin: pixel count, red sum, green sum, blue sum
+    static const int bins = 1 << 15;
+    std::vector<quint64> histogram(bins * 4, 0);
+    QMutex mutex;
+    const int width = argb.width();
+
+    parallel_for(argb.height(), [&](int begin, int end) {
+        std::vector<quint64> local(bins * 4, 0);
+        for ( int y = begin; y < end; y++ )
+        {
+            const QRgb* line = reinterpret_cast<const QRgb*>(argb.constScanLine(y));
+            for ( int x = 0; x < width; x++ )
+            {
+                QRgb pixel = line[x];
+                if ( qAlpha(pixel) == 0 )
+                    continue;
+                quint32 bin = ((pixel >> 9) & 0x7c00) |
+                              ((pixel >> 6) & 0x03e0) |
+                              ((pixel >> 3) & 0x001f);
+                quint64* entry = local.data() + bin * 4;
+                entry[0]++;
+                entry[1] += qRed(pixel);
+                entry[2] += qGreen(pixel);
+                entry[3] += qBlue(pixel);
+            }
+        }
+
+        QMutexLocker lock(&mutex);
+        for ( int i = 0; i < bins * 4; i++ )
+            histogram[i] += local[i];
+    }, 64);
+
+    QVector<ColorSample> samples;
+    for ( int bin = 0; bin < bins; bin++ )
+    {
+        const quint64* entry = histogram.data() + bin * 4;
+        if ( !entry[0] )
+            continue;
+        ColorSample sample;
+        sample.weight = entry[0];
+        for ( int i = 0; i < 3; i++ )
+            sample.rgb[i] = float(double(entry[i+1]) / entry[0]);
+        sample_set_position(sample, space);
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+namespace {
+
+/**
+ * \brief Range of samples for median cut
+ */
+struct CutBox
+{
+    int begin;
+    int end;
+    int axis;       ///< Axis with the largest variance
+    double score;   ///< Total weighted variance, < 0 if it can't be split
+};
+
+CutBox make_box(const QVector<ColorSample>& samples, int begin, int end)
+{
+    CutBox box{begin, end, 0, -1};
+    if ( end - begin < 2 )
+        return box;
+
+    double weight = 0;
+    double sum[3] = {0, 0, 0};
+    double sum_sq[3] = {0, 0, 0};
+    for ( int i = begin; i < end; i++ )
+    {
+        const ColorSample& sample = samples[i];
+        weight += sample.weight;
+        for ( int c = 0; c < 3; c++ )
+        {
+            sum[c] += sample.pos[c] * double(sample.weight);
+            sum_sq[c] += sample.pos[c] * double(sample.pos[c]) * sample.weight;
+        }
+    }
+
+    box.score = 0;
+    double best = -1;
+    for ( int c = 0; c < 3; c++ )
+    {
+        double variance = sum_sq[c] - sum[c] * sum[c] / weight;
+        box.score += variance;
+        if ( variance > best )
+        {
+            best = variance;
+            box.axis = c;
+        }
+    }
+    return box;
+}
+
+ColorSample merge_samples(const ColorSample* begin, const ColorSample* end)
+{
+    double weight = 0;
+    double pos[3] = {0, 0, 0};
+    double rgb[3] = {0, 0, 0};
+    for ( const ColorSample* sample = begin; sample != end; ++sample )
+    {
+        weight += sample->weight;
+        for ( int c = 0; c < 3; c++ )
+        {
+            pos[c] += sample->pos[c] * double(sample->weight);
+            rgb[c] += sample->rgb[c] * double(sample->weight);
+        }
+    }
+
+    ColorSample merged;
+    merged.weight = quint64(weight);
+    for ( int c = 0; c < 3; c++ )
+    {
+        merged.pos[c] = weight > 0 ? pos[c] / weight : 0;
+        merged.rgb[c] = weight > 0 ? rgb[c] / weight : 0;
+    }
+    return merged;
+}
+
+struct OctreeNode
+{
+    double  sum[3];
+    quint64 weight;
+    int     children[8];
+    bool    leaf;
+
+    OctreeNode()
+        : sum{0, 0, 0}, weight(0), leaf(false)
+    {
+        std::fill(children, children + 8, -1);
+    }
+};
+
+void octree_collect(const std::vector<OctreeNode>& nodes, int index,
+                    QVector<ColorSample>& output)
+{
+    const OctreeNode& node = nodes[index];
+    if ( node.leaf )
+    {
+        ColorSample sample;
+        sample.weight = node.weight;
+        for ( int c = 0; c < 3; c++ )
+        {
+            sample.rgb[c] = node.sum[c] / node.weight;
+            sample.pos[c] = sample.rgb[c];
+        }
+        output.push_back(sample);
+        return;
+    }
+
+    for ( int child : node.children )
+        if ( child != -1 )
+            octree_collect(nodes, child, output);
+}
+
+} // namespace
+
+QVector<ColorSample> median_cut(QVector<ColorSample> samples, int count)
+{
+    QVector<CutBox> boxes;
+    if ( samples.empty() || count <= 0 )
+        return QVector<ColorSample>();
+
+    boxes.push_back(make_box(samples, 0, samples.size()));
+    while ( boxes.size() < count )
+    {
+        int best = 0;
+        for ( int i = 1; i < boxes.size(); i++ )
+            if ( boxes[i].score > boxes[best].score )
+                best = i;
+
+        CutBox box = boxes[best];
+        if ( box.score <= 0 )
+            break;
+
+        int axis = box.axis;
+        ColorSample* data = samples.data();
+        std::sort(data + box.begin, data + box.end,
+            [axis](const ColorSample& a, const ColorSample& b) {
+                return a.pos[axis] < b.pos[axis];
+            });
+
+        quint64 total = 0;
+        for ( int i = box.begin; i < box.end; i++ )
+            total += data[i].weight;
+
+        quint64 accumulated = 0;
+        int split = box.begin + 1;
+        for ( int i = box.begin; i < box.end - 1; i++ )
+        {
+            accumulated += data[i].weight;
+            split = i + 1;
+            if ( accumulated * 2 >= total )
+                break;
+        }
+
+        boxes[best] = make_box(samples, box.begin, split);
+        boxes.push_back(make_box(samples, split, box.end));
+    }
+
+    QVector<ColorSample> result;
+    result.reserve(boxes.size());
+    for ( const CutBox& box : boxes )
+        result.push_back(merge_samples(samples.constData() + box.begin,
+                                       samples.constData() + box.end));
+    return result;
+}
+
+QVector<ColorSample> octree_reduce(const QVector<ColorSample>& samples, int count)
+{
+    static const int max_depth = 6;
+
+    if ( samples.empty() || count <= 0 )
+        return QVector<ColorSample>();
+
+    std::vector<OctreeNode> nodes(1);
+    std::vector<std::vector<int>> levels(max_depth);
+    levels[0].push_back(0);
+    int leaves = 0;
+
+    for ( const ColorSample& sample : samples )
+    {
+        int rgb[3];
+        for ( int c = 0; c < 3; c++ )
+            rgb[c] = qBound(0, qRound(sample.rgb[c]), 255);
+
+        int node = 0;
+        for ( int level = 0; ; level++ )
+        {
+            nodes[node].weight += sample.weight;
+            for ( int c = 0; c < 3; c++ )
+                nodes[node].sum[c] += sample.rgb[c] * double(sample.weight);
+
+            if ( level == max_depth )
+                break;
+
+            int shift = 7 - level;
+            int child = ((rgb[0] >> shift) & 1) << 2 |
+                        ((rgb[1] >> shift) & 1) << 1 |
+                        ((rgb[2] >> shift) & 1);
+            if ( nodes[node].children[child] == -1 )
+            {
+                int index = nodes.size();
+                nodes.push_back(OctreeNode());
+                nodes[node].children[child] = index;
+                if ( level + 1 == max_depth )
+                {
+                    nodes[index].leaf = true;
+                    leaves++;
+                }
+                else
+                {
+                    levels[level + 1].push_back(index);
+                }
+            }
+            node = nodes[node].children[child];
+        }
+    }
+
+    // Fold the least populated nodes of the deepest level first
+    for ( int level = max_depth - 1; level >= 0 && leaves > count; level-- )
+    {
+        std::vector<int>& candidates = levels[level];
+        std::sort(candidates.begin(), candidates.end(), [&nodes](int a, int b) {
+            return nodes[a].weight < nodes[b].weight;
+        });
+
+        for ( int index : candidates )
+        {
+            if ( leaves <= count )
+                break;
+
+            OctreeNode& node = nodes[index];
+            int children = 0;
+            for ( int& child : node.children )
+            {
+                if ( child != -1 )
+                {
+                    children++;
+                    child = -1;
+                }
+            }
+            node.leaf = true;
+            leaves -= children - 1;
+        }
+    }
+
+    QVector<ColorSample> result;
+    result.reserve(leaves);
+    octree_collect(nodes, 0, result);
+    return result;
+}
+
+QVector<int> kmeans(const QVector<ColorSample>& samples,
+                    QVector<ColorSample>& centroids,
+                    int max_iterations)
+{
+    QVector<int> assignment(samples.size(), -1);
+    if ( centroids.empty() )
+        return assignment;
+
+    const ColorSample* input = samples.constData();
+    int* assigned = assignment.data();
+
+    for ( int iteration = 0; iteration < max_iterations; iteration++ )
+    {
+        const ColorSample* means = centroids.constData();
+        const int n_means = centroids.size();
+        std::atomic<bool> changed(false);
+
+        parallel_for(samples.size(), [&](int begin, int end) {
+            bool local_changed = false;
+            for ( int i = begin; i < end; i++ )
+            {
+                int best = 0;
+                float best_distance = std::numeric_limits<float>::max();
+                for ( int j = 0; j < n_means; j++ )
+                {
+                    float d0 = input[i].pos[0] - means[j].pos[0];
+                    float d1 = input[i].pos[1] - means[j].pos[1];
+                    float d2 = input[i].pos[2] - means[j].pos[2];
+                    float distance = d0 * d0 + d1 * d1 + d2 * d2;
+                    if ( distance < best_distance )
+                    {
+                        best_distance = distance;
+                        best = j;
+                    }
+                }
+                if ( assigned[i] != best )
+                {
+                    assigned[i] = best;
+                    local_changed = true;
+                }
+            }
+            if ( local_changed )
+                changed = true;
+        }, 256);
+
+        if ( !changed )
+            break;
+
+        std::vector<double> sums(n_means * 7, 0);
+        for ( int i = 0; i < samples.size(); i++ )
+        {
+            double* sum = sums.data() + assigned[i] * 7;
+            double weight = input[i].weight;
+            sum[0] += weight;
+            for ( int c = 0; c < 3; c++ )
+            {
+                sum[1 + c] += input[i].pos[c] * weight;
+                sum[4 + c] += input[i].rgb[c] * weight;
+            }
+        }
+
+        for ( int j = 0; j < n_means; j++ )
+        {
+            const double* sum = sums.data() + j * 7;
+            ColorSample& centroid = centroids[j];
+            centroid.weight = quint64(sum[0]);
+            if ( sum[0] > 0 )
+            {
+                for ( int c = 0; c < 3; c++ )
+                {
+                    centroid.pos[c] = sum[1 + c] / sum[0];
+                    centroid.rgb[c] = sum[4 + c] / sum[0];
+                }
+            }
+        }
+    }
+
+    // Drop empty clusters
+    QVector<int> remap(centroids.size(), -1);
+    QVector<ColorSample> kept;
+    for ( int j = 0; j < centroids.size(); j++ )
+    {
+        if ( centroids[j].weight > 0 )
+        {
+            remap[j] = kept.size();
+            kept.push_back(centroids[j]);
+        }
+    }
+    if ( kept.size() != centroids.size() )
+    {
+        centroids = kept;
+        for ( int& index : assignment )
+            index = remap[index];
+    }
+
+    return assignment;
+}
+
+QVector<QColor> quantize_image(const QImage& image, int count,
+                               ColorPalette::QuantizationMethod method,
+                               ColorPalette::QuantizationSpace space)
+{
+    if ( count <= 0 || image.isNull() )
+        return QVector<QColor>();
+
+    QVector<ColorSample> samples = image_histogram(image, space);
+    QVector<ColorSample> result;
+
+    if ( samples.size() <= count )
+    {
+        result = samples;
+    }
+    else if ( method == ColorPalette::Octree )
+    {
+        result = octree_reduce(samples, count);
+    }
+    else
+    {
+        result = median_cut(samples, count);
+        if ( method == ColorPalette::KMeans )
+            kmeans(samples, result);
+    }
+
+    std::stable_sort(result.begin(), result.end(),
+        [](const ColorSample& a, const ColorSample& b) {
+            return a.weight > b.weight;
+        });
+
+    QVector<QColor> colors;
+    colors.reserve(result.size());
+    for ( const ColorSample& sample : result )
+        colors.push_back(QColor(
+            qBound(0, qRound(sample.rgb[0]), 255),
+            qBound(0, qRound(sample.rgb[1]), 255),
+            qBound(0, qRound(sample.rgb[2]), 255)
+        ));
+    return colors;
+}
+
+namespace {
+
+/**
+ * \brief Direct mapped cache in front of a NearestColorIndex
+ *
+ * Not shared between threads, each worker has its own.
+ */
+class NearestCache
+{
+public:
+    explicit NearestCache(const NearestColorIndex& index)
+        : index(index), keys(size, 0), values(size, 0)
+    {}
+
+    int nearest(QRgb rgb)
+    {
+        // Opaque so 0 can mark empty slots
+        rgb |= 0xff000000u;
+        quint32 slot = (rgb * 0x9E3779B1u) >> (32 - bits);
+        if ( keys[slot] != rgb )
+        {
+            keys[slot] = rgb;
+            values[slot] = index.nearest(rgb);
+        }
+        return values[slot];
+    }
+
+private:
+    static const int bits = 12;
+    static const int size = 1 << bits;
+
+    const NearestColorIndex& index;
+    std::vector<QRgb> keys;
+    std::vector<int> values;
+};
+
+/**
+ * \brief Writes palette indices to the output image
+ */
+struct RemapOutput
+{
+    uchar*       bits;
+    int          bytes_per_line;
+    bool         indexed;
+    const QRgb*  colors;
+
+    void set(int x, int y, int index) const
+    {
+        uchar* line = bits + y * bytes_per_line;
+        if ( indexed )
+            line[x] = uchar(index);
+        else
+            reinterpret_cast<QRgb*>(line)[x] = colors[index];
+    }
+};
+
+const int bayer_matrix[8][8] = {
+    { 0, 32,  8, 40,  2, 34, 10, 42},
+    {48, 16, 56, 24, 50, 18, 58, 26},
+    {12, 44,  4, 36, 14, 46,  6, 38},
+    {60, 28, 52, 20, 62, 30, 54, 22},
+    { 3, 35, 11, 43,  1, 33,  9, 41},
+    {51, 19, 59, 27, 49, 17, 57, 25},
+    {15, 47,  7, 39, 13, 45,  5, 37},
+    {63, 31, 55, 23, 61, 29, 53, 21},
+};
+
+int clamp_channel(float value)
+{
+    return qBound(0, int(value + 0.5f), 255);
+}
+
+/**
+ * \brief Remapping without dithering or with ordered dithering
+ *
+ * Rows are independent so they are just split across threads.
+ */
+void remap_rows(const QImage& image, const RemapOutput& out,
+                const NearestColorIndex& index, int color_count, bool ordered)
+{
+    const int width = image.width();
+    // Spacing between palette colors if they were uniformly spread
+    const float spread = 255.f / std::cbrt(float(color_count));
+
+    parallel_for(image.height(), [&](int begin, int end) {
+        NearestCache cache(index);
+        for ( int y = begin; y < end; y++ )
+        {
+            const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+            for ( int x = 0; x < width; x++ )
+            {
+                QRgb pixel = line[x];
+                if ( ordered )
+                {
+                    float offset = ((bayer_matrix[y & 7][x & 7] + 0.5f) / 64 - 0.5f) * spread;
+                    pixel = qRgb(
+                        clamp_channel(qRed(pixel) + offset),
+                        clamp_channel(qGreen(pixel) + offset),
+                        clamp_channel(qBlue(pixel) + offset)
+                    );
+                }
+                out.set(x, y, cache.nearest(pixel));
+            }
+        }
+    }, qMax(1, 16384 / qMax(1, width)));
+}
+
+/**
+ * \brief Floyd-Steinberg error diffusion
+ *
+ * Rows are processed left to right as a wavefront: workers claim rows in
+ * order and pixel x of a row waits for the row above to be past x + 1,
+ * after which all the error it receives has been accumulated.
+ * Error rows are kept in a ring buffer, a slot is only reused once the row
+ * that read from it has completed.
+ */
+void remap_diffuse(const QImage& image, const RemapOutput& out,
+                   const NearestColorIndex& index, const QVector<QRgb>& colors)
+{
+    const int width = image.width();
+    const int height = image.height();
+    const int max_workers = qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    const int workers = qBound(1, int(qint64(width) * height / 65536), qMin(max_workers, height));
+    const int ring = workers * 2 + 2;
+    // Each error row has one pixel of padding on either side
+    const int stride = (width + 2) * 3;
+    // How often a row publishes its progress
+    static const int progress_step = 32;
+
+    std::vector<float> errors(ring * stride, 0.f);
+    std::vector<std::atomic<int>> progress(height);
+    for ( auto& row : progress )
+        row.store(0, std::memory_order_relaxed);
+    std::atomic<int> next_row(0);
+
+    auto wait_for = [&progress](int row, int columns, int& available) {
+        while ( available < columns )
+        {
+            available = progress[row].load(std::memory_order_acquire);
+            if ( available < columns )
+                QThread::yieldCurrentThread();
+        }
+    };
+
+    auto process_row = [&](int y, NearestCache& cache) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        const float* current = errors.data() + (y % ring) * stride + 3;
+        float* next = errors.data() + ((y + 1) % ring) * stride + 3;
+
+        if ( y + 1 < height )
+        {
+            if ( y + 1 >= ring )
+            {
+                int done = 0;
+                wait_for(y + 1 - ring, width, done);
+            }
+            std::fill(next - 3, next - 3 + stride, 0.f);
+        }
+
+        int available = y == 0 ? width : 0;
+        float carry[3] = {0, 0, 0};
+        for ( int x = 0; x < width; x++ )
+        {
+            if ( y > 0 )
+                wait_for(y - 1, qMin(x + 2, width), available);
+
+            QRgb pixel = line[x];
+            float value[3] = {
+                qBound(0.f, qRed(pixel) + current[x*3] + carry[0], 255.f),
+                qBound(0.f, qGreen(pixel) + current[x*3+1] + carry[1], 255.f),
+                qBound(0.f, qBlue(pixel) + current[x*3+2] + carry[2], 255.f),
+            };
+            int match = cache.nearest(qRgb(
+                clamp_channel(value[0]),
+                clamp_channel(value[1]),
+                clamp_channel(value[2])
+            ));
+            out.set(x, y, match);
+
+            QRgb chosen = colors[match];
+            float error[3] = {
+                value[0] - qRed(chosen),
+                value[1] - qGreen(chosen),
+                value[2] - qBlue(chosen),
+            };
+            for ( int c = 0; c < 3; c++ )
+            {
+                carry[c] = error[c] * (7.f / 16);
+                next[(x-1)*3+c] += error[c] * (3.f / 16);
+                next[x*3+c] += error[c] * (5.f / 16);
+                next[(x+1)*3+c] += error[c] * (1.f / 16);
+            }
+
+            if ( x % progress_step == progress_step - 1 )
+                progress[y].store(x + 1, std::memory_order_release);
+        }
+        progress[y].store(width, std::memory_order_release);
+    };
+
+    parallel_for(workers, [&](int, int) {
+        NearestCache cache(index);
+        for ( int y = next_row++; y < height; y = next_row++ )
+            process_row(y, cache);
+    });
+}
+
+} // namespace
+
+QImage remap_image(const QImage& image, const QVector<QRgb>& colors,
+                   const NearestColorIndex& index,
+                   ColorPalette::Dithering dithering)
+{
+    if ( image.isNull() || colors.empty() )
+        return QImage();
+
+    QImage rgb = image;
+    if ( rgb.format() != QImage::Format_RGB32 && rgb.format() != QImage::Format_ARGB32 )
+        rgb = rgb.convertToFormat(QImage::Format_ARGB32);
+
+    bool indexed = colors.size() <= 256;
+    QImage result(rgb.size(), indexed ? QImage::Format_Indexed8 : QImage::Format_RGB32);
+    if ( indexed )
+        result.setColorTable(colors);
+    result.setDotsPerMeterX(image.dotsPerMeterX());
+    result.setDotsPerMeterY(image.dotsPerMeterY());
+
+    // bits() detaches, so it's called here rather than from the workers
+    RemapOutput out{result.bits(), result.bytesPerLine(), indexed, colors.constData()};
+
+    if ( dithering == ColorPalette::DiffuseDithering )
+        remap_diffuse(rgb, out, index, colors);
+    else
+        remap_rows(rgb, out, index, colors.size(), dithering == ColorPalette::OrderedDithering);
+
+    return result;
+}
+
+} // namespace detail
+} // namespace color_widgets
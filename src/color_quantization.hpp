@@ -0,0 +1,102 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_COLOR_QUANTIZATION_HPP
+#define COLOR_WIDGETS_COLOR_QUANTIZATION_HPP
+
+#include <QImage>
+#include <QVector>
+#include "color_palette.hpp"
+#include "nearest_color.hpp"
+
+namespace color_widgets {
+namespace detail {
+
+/**
+ * \brief A weighted point in color space, input of the clustering algorithms
+ */
+struct ColorSample
+{
+    float   pos[3]; ///< Coordinates in the color space used for comparisons
+    float   rgb[3]; ///< Mean sRGB components in [0-255]
+    quint64 weight; ///< Number of pixels or entries represented by the sample
+};
+
+/**
+ * \brief Sets \c pos from \c rgb according to \p space
+ */
+void sample_set_position(ColorSample& sample, ColorPalette::QuantizationSpace space);
+
+/**
+ * \brief Builds a weighted histogram of the image colors
+ *
+ * Colors are binned to 5 bits per channel, each sample keeps the mean of the
+ * pixels that fell in its bin. Fully transparent pixels are skipped.
+ */
+QVector<ColorSample> image_histogram(const QImage& image,
+                                     ColorPalette::QuantizationSpace space);
+
+/**
+ * \brief Variance-based median cut
+ * \returns At most \p count samples, one per box
+ */
+QVector<ColorSample> median_cut(QVector<ColorSample> samples, int count);
+
+/**
+ * \brief Octree color reduction, works on \c rgb and ignores \c pos
+ * \returns At most \p count samples, one per leaf
+ */
+QVector<ColorSample> octree_reduce(const QVector<ColorSample>& samples, int count);
+
+/**
+ * \brief Weighted k-means clustering
+ *
+ * \param centroids Initial centroids, updated with the result.
+ *                  Clusters that end up empty are removed.
+ * \returns The index in \p centroids of the cluster of each sample
+ */
+QVector<int> kmeans(const QVector<ColorSample>& samples,
+                    QVector<ColorSample>& centroids,
+                    int max_iterations = 16);
+
+/**
+ * \brief Quantizes the image to at most \p count colors
+ * \returns The colors, most populated first
+ */
+QVector<QColor> quantize_image(const QImage& image, int count,
+                               ColorPalette::QuantizationMethod method,
+                               ColorPalette::QuantizationSpace space);
+
+/**
+ * \brief Maps each pixel of \p image to the nearest of \p colors
+ *
+ * \param colors Opaque palette colors
+ * \param index  Nearest color lookup built from \p colors
+ * \returns Format_Indexed8 if there are at most 256 colors, Format_RGB32 otherwise
+ */
+QImage remap_image(const QImage& image, const QVector<QRgb>& colors,
+                   const NearestColorIndex& index,
+                   ColorPalette::Dithering dithering);
+
+} // namespace detail
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_COLOR_QUANTIZATION_HPP
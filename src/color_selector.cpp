@@ -24,40 +24,128 @@
 #include <QDropEvent>
 #include <QDragEnterEvent>
 #include <QMimeData>
+#include <QPointer>
+#include <QVariant>
 
 namespace color_widgets {
 
+/// Object name of the dialogs shared by selectors in the same window
+static const char* const shared_dialog_name = "color_widgets_shared_dialog";
+/// Dynamic property of the dialog with the selector it's working for
+static const char* const dialog_owner = "color_widgets_selector";
+
+/**
+ * \brief Fills the unspecified groups of \p flags like ColorWheel does
+ */
+static ColorWheel::DisplayFlags complete_flags(ColorWheel::DisplayFlags flags)
+{
+    const ColorWheel::DisplayFlags groups[] = {
+        ColorWheel::SHAPE_FLAGS, ColorWheel::ANGLE_FLAGS, ColorWheel::COLOR_FLAGS
+    };
+    for ( ColorWheel::DisplayFlags mask : groups )
+        if ( !(flags & mask) )
+            flags |= ColorWheel::defaultDisplayFlags(mask);
+    return flags;
+}
+
 class ColorSelector::Private
 {
 public:
     UpdateMode update_mode;
-    ColorDialog *dialog;
+    /// Created on the first showDialog()
+    QPointer<ColorDialog> dialog;
+    bool shared_dialog = false;
+    Qt::WindowModality dialog_modality = Qt::NonModal;
+    ColorWheel::DisplayFlags wheel_flags = complete_flags(ColorWheel::FLAGS_DEFAULT);
     QColor old_color;
 
-    Private(QWidget *widget) : dialog(new ColorDialog(widget))
+    /**
+     * \brief Whether the dialog is currently working for \p selector
+     */
+    bool attached(const ColorSelector* selector) const
     {
+        return dialog && dialog->property(dialog_owner).value<QObject*>() == selector;
+    }
+
+    void create_dialog(ColorSelector* selector)
+    {
+        if ( dialog )
+        {
+            if ( !shared_dialog || dialog->parentWidget() == selector->window() )
+                return;
+
+            // The selector has been moved to another window since
+            if ( attached(selector) )
+                dialog->hide();
+            detach(selector);
+            dialog = nullptr;
+        }
+
+        if ( shared_dialog )
+        {
+            QWidget* window = selector->window();
+            dialog = window->findChild<ColorDialog*>(QLatin1String(shared_dialog_name),
+                                                     Qt::FindDirectChildrenOnly);
+            if ( dialog )
+                return;
+            dialog = new ColorDialog(window);
+            dialog->setObjectName(QLatin1String(shared_dialog_name));
+        }
+        else
+        {
+            dialog = new ColorDialog(selector);
+        }
         dialog->setButtonMode(ColorDialog::OkCancel);
     }
+
+    /**
+     * \brief Makes the dialog work for \p selector, taking it from other selectors
+     */
+    void attach(ColorSelector* selector)
+    {
+        create_dialog(selector);
+        if ( attached(selector) )
+            return;
+
+        if ( QObject* owner = dialog->property(dialog_owner).value<QObject*>() )
+            dialog->disconnect(owner);
+        dialog->setProperty(dialog_owner, QVariant::fromValue<QObject*>(selector));
+
+        dialog->setWindowModality(dialog_modality);
+        dialog->setWheelFlags(wheel_flags);
+        connect(dialog.data(), &QDialog::rejected, selector, &ColorSelector::reject_dialog);
+        connect(dialog.data(), &ColorDialog::colorSelected, selector, &ColorSelector::accept_dialog);
+        connect(dialog.data(), &ColorDialog::wheelFlagsChanged,
+                selector, &ColorSelector::update_wheel_flags);
+    }
+
+    void detach(ColorSelector* selector)
+    {
+        if ( attached(selector) )
+        {
+            dialog->disconnect(selector);
+            dialog->setProperty(dialog_owner, QVariant());
+        }
+    }
 };
 
 ColorSelector::ColorSelector(QWidget *parent) :
-    ColorPreview(parent), p(new Private(this))
+    ColorPreview(parent), p(new Private)
 {
     setUpdateMode(Continuous);
     p->old_color = color();
 
     connect(this,&ColorPreview::clicked,this,&ColorSelector::showDialog);
     connect(this,SIGNAL(colorChanged(QColor)),this,SLOT(update_old_color(QColor)));
-    connect(p->dialog,&QDialog::rejected,this,&ColorSelector::reject_dialog);
-    connect(p->dialog,&ColorDialog::colorSelected, this, &ColorSelector::accept_dialog);
-    connect(p->dialog,&ColorDialog::wheelFlagsChanged,
-                this, &ColorSelector::wheelFlagsChanged);
 
     setAcceptDrops(true);
 }
 
 ColorSelector::~ColorSelector()
 {
+    if ( p->shared_dialog && p->attached(this) )
+        p->dialog->hide();
+    p->detach(this);
     delete p;
 }
 
@@ -73,21 +161,51 @@ void ColorSelector::setUpdateMode(UpdateMode m)
 
 Qt::WindowModality ColorSelector::dialogModality() const
 {
-    return p->dialog->windowModality();
+    return p->dialog_modality;
 }
 
 void ColorSelector::setDialogModality(Qt::WindowModality m)
 {
-    p->dialog->setWindowModality(m);
+    p->dialog_modality = m;
+    if ( p->attached(this) )
+        p->dialog->setWindowModality(m);
 }
 
 ColorWheel::DisplayFlags ColorSelector::wheelFlags() const
 {
-    return p->dialog->wheelFlags();
+    return p->wheel_flags;
+}
+
+bool ColorSelector::sharedDialog() const
+{
+    return p->shared_dialog;
+}
+
+void ColorSelector::setSharedDialog(bool shared)
+{
+    if ( shared == p->shared_dialog )
+        return;
+
+    if ( p->dialog )
+    {
+        if ( p->shared_dialog )
+        {
+            if ( p->attached(this) )
+                p->dialog->hide();
+            p->detach(this);
+        }
+        else
+        {
+            p->dialog->deleteLater();
+        }
+        p->dialog = nullptr;
+    }
+    p->shared_dialog = shared;
 }
 
 void ColorSelector::showDialog()
 {
+    p->attach(this);
     p->old_color = color();
     p->dialog->setColor(color());
     connect_dialog();
@@ -96,7 +214,11 @@ void ColorSelector::showDialog()
 
 void ColorSelector::setWheelFlags(ColorWheel::DisplayFlags flags)
 {
-    p->dialog->setWheelFlags(flags);
+    flags = complete_flags(flags);
+    if ( p->attached(this) )
+        p->dialog->setWheelFlags(flags);
+    else
+        update_wheel_flags(flags);
 }
 
 void ColorSelector::connect_dialog()
@@ -125,10 +247,19 @@ void ColorSelector::reject_dialog()
 
 void ColorSelector::update_old_color(const QColor &c)
 {
-    if (!p->dialog->isVisible())
+    if (!p->attached(this) || !p->dialog->isVisible())
         p->old_color = c;
 }
 
+void ColorSelector::update_wheel_flags(ColorWheel::DisplayFlags flags)
+{
+    if ( flags != p->wheel_flags )
+    {
+        p->wheel_flags = flags;
+        Q_EMIT wheelFlagsChanged(flags);
+    }
+}
+
 void ColorSelector::dragEnterEvent(QDragEnterEvent *event)
 {
     if ( event->mimeData()->hasColor() ||
@@ -21,6 +21,14 @@
  */
 #include "color_utils.hpp"
 
+#include <cmath>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QVector>
+#include <QPair>
+#include "color_names.hpp"
+
 namespace color_widgets {
 namespace detail {
 
@@ -79,5 +87,199 @@ QColor color_from_hsl(qreal hue, qreal sat, qreal lig, qreal alpha )
         alpha);
 }
 
+QString color_name_hint(const QColor& color)
+{
+    qreal distance = 0;
+    QString name = nearestColorName(color, &distance);
+    // OKLab distances this small are rounding errors of exact matches
+    if ( distance < 1e-4 )
+        return name;
+    return QString(QChar(0x2248)) + QLatin1Char(' ') + name;
+}
+
+float srgb_to_linear(float c)
+{
+    if ( c <= 0.04045f )
+        return c / 12.92f;
+    return std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float linear_to_srgb(float c)
+{
+    if ( c <= 0.0031308f )
+        return c * 12.92f;
+    return 1.055f * std::pow(c, 1 / 2.4f) - 0.055f;
+}
+
+float srgb8_to_linear(int c)
+{
+    struct Table
+    {
+        float values[256];
+        Table()
+        {
+            for ( int i = 0; i < 256; i++ )
+                values[i] = srgb_to_linear(i / 255.f);
+        }
+    };
+    static const Table table;
+    return table.values[c & 0xff];
+}
+
+Oklab linear_rgb_to_oklab(float r, float g, float b)
+{
+    float l = std::cbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+    float m = std::cbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+    float s = std::cbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+
+    return Oklab{
+        0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s,
+        1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s,
+        0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s,
+    };
+}
+
+void oklab_to_linear_rgb(const Oklab& lab, float& r, float& g, float& b)
+{
+    float l = lab.l + 0.3963377774f * lab.a + 0.2158037573f * lab.b;
+    float m = lab.l - 0.1055613458f * lab.a - 0.0638541728f * lab.b;
+    float s = lab.l - 0.0894841775f * lab.a - 1.2914855480f * lab.b;
+    l = l * l * l;
+    m = m * m * m;
+    s = s * s * s;
+
+    r = +4.0767416621f * l - 3.3077115913f * m + 0.2309699292f * s;
+    g = -1.2684380046f * l + 2.6097574011f * m - 0.3413193965f * s;
+    b = -0.0041960863f * l - 0.7034186147f * m + 1.7076147010f * s;
+}
+
+Oklab rgb_to_oklab(QRgb rgb)
+{
+    return linear_rgb_to_oklab(
+        srgb8_to_linear(qRed(rgb)),
+        srgb8_to_linear(qGreen(rgb)),
+        srgb8_to_linear(qBlue(rgb))
+    );
+}
+
+int linear_to_srgb8(float c)
+{
+    return qBound(0, qRound(linear_to_srgb(qBound(0.f, c, 1.f)) * 255), 255);
+}
+
+QRgb oklab_to_rgb(const Oklab& lab)
+{
+    float r, g, b;
+    oklab_to_linear_rgb(lab, r, g, b);
+    return qRgb(linear_to_srgb8(r), linear_to_srgb8(g), linear_to_srgb8(b));
+}
+
+static float cielab_f(float t)
+{
+    static const float delta = 6.f / 29;
+    return t > delta * delta * delta ? std::cbrt(t) : t / (3 * delta * delta) + 4.f / 29;
+}
+
+CieLab linear_rgb_to_cielab(float r, float g, float b)
+{
+    // XYZ relative to the D65 white point
+    float x = (0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / 0.95047f;
+    float y =  0.2126729f * r + 0.7151522f * g + 0.0721750f * b;
+    float z = (0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / 1.08883f;
+
+    float fx = cielab_f(x);
+    float fy = cielab_f(y);
+    float fz = cielab_f(z);
+    return CieLab{116 * fy - 16, 500 * (fx - fy), 200 * (fy - fz)};
+}
+
+CieLab rgb_to_cielab(QRgb rgb)
+{
+    return linear_rgb_to_cielab(
+        srgb8_to_linear(qRed(rgb)),
+        srgb8_to_linear(qGreen(rgb)),
+        srgb8_to_linear(qBlue(rgb))
+    );
+}
+
+namespace {
+
+class RangeTask : public QRunnable
+{
+public:
+    RangeTask(const std::function<void(int, int)>& func, int begin, int end,
+              QSemaphore* done)
+        : func(func), begin(begin), end(end), done(done)
+    {}
+
+    void run() Q_DECL_OVERRIDE
+    {
+        func(begin, end);
+        done->release();
+    }
+
+private:
+    const std::function<void(int, int)>& func;
+    int begin;
+    int end;
+    QSemaphore* done;
+};
+
+} // namespace
+
+int parallel_chunks(int size, int min_chunk)
+{
+    int threads = QThreadPool::globalInstance()->maxThreadCount();
+    return qBound(1, size / qMax(1, min_chunk), qMax(1, threads));
+}
+
+void parallel_for(int size, const std::function<void(int, int)>& func, int min_chunk)
+{
+    if ( size <= 0 )
+        return;
+
+    QThreadPool* pool = QThreadPool::globalInstance();
+    int chunks = parallel_chunks(size, min_chunk);
+    if ( chunks == 1 )
+    {
+        func(0, size);
+        return;
+    }
+
+    QSemaphore done;
+    int started = 0;
+    QVector<QPair<int, int>> local;
+    int step = size / chunks;
+    int extra = size % chunks;
+    for ( int i = 0, begin = 0; i < chunks; i++ )
+    {
+        int end = begin + step + (i < extra ? 1 : 0);
+        if ( i == 0 )
+        {
+            local.push_back(qMakePair(begin, end));
+        }
+        else
+        {
+            RangeTask* task = new RangeTask(func, begin, end, &done);
+            task->setAutoDelete(true);
+            if ( pool->tryStart(task) )
+            {
+                started++;
+            }
+            else
+            {
+                delete task;
+                local.push_back(qMakePair(begin, end));
+            }
+        }
+        begin = end;
+    }
+
+    for ( const auto& range : local )
+        func(range.first, range.second);
+
+    done.acquire(started);
+}
+
 } // namespace detail
 } // namespace color_widgets
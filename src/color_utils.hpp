@@ -19,6 +19,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#ifndef COLOR_WIDGETS_COLOR_UTILS_HPP
+#define COLOR_WIDGETS_COLOR_UTILS_HPP
+
+#include <algorithm>
+#include <functional>
 #include <QColor>
 #include <qmath.h>
 
@@ -66,5 +71,131 @@ inline qreal color_HSL_saturationF(const QColor& col)
 
 QColor color_from_hsl(qreal hue, qreal sat, qreal lig, qreal alpha = 1 );
 
+/**
+ * \brief Closest CSS color name, marked as approximate unless it's an exact match
+ */
+QString color_name_hint(const QColor& color);
+
+/**
+ * \brief Color in the OKLab perceptual color space
+ *
+ * \c l is in [0-1], \c a and \c b are roughly in [-0.4, 0.4]
+ */
+struct Oklab
+{
+    float l, a, b;
+};
+
+/**
+ * \brief Converts a gamma-encoded sRGB component in [0-1] to linear light
+ */
+float srgb_to_linear(float c);
+
+/**
+ * \brief Converts a linear light component in [0-1] to gamma-encoded sRGB
+ */
+float linear_to_srgb(float c);
+
+/**
+ * \brief Converts an 8 bit sRGB component to linear light (table lookup)
+ */
+float srgb8_to_linear(int c);
+
+/**
+ * \brief Converts a linear light component to an 8 bit sRGB value, clamping
+ */
+int linear_to_srgb8(float c);
+
+/**
+ * \brief Converts linear sRGB components to OKLab
+ */
+Oklab linear_rgb_to_oklab(float r, float g, float b);
+
+/**
+ * \brief Converts OKLab to linear sRGB components, without clamping
+ */
+void oklab_to_linear_rgb(const Oklab& lab, float& r, float& g, float& b);
+
+/**
+ * \brief Converts a QRgb (alpha is ignored) to OKLab
+ */
+Oklab rgb_to_oklab(QRgb rgb);
+
+/**
+ * \brief Converts OKLab to an opaque QRgb, clamping out of gamut colors
+ */
+QRgb oklab_to_rgb(const Oklab& lab);
+
+/**
+ * \brief Color in the CIE L*a*b* color space, D65 white point
+ *
+ * \c l is in [0-100], \c a and \c b are roughly in [-128, 128]
+ */
+struct CieLab
+{
+    float l, a, b;
+};
+
+/**
+ * \brief Converts linear sRGB components to CIE L*a*b*
+ */
+CieLab linear_rgb_to_cielab(float r, float g, float b);
+
+/**
+ * \brief Converts a QRgb (alpha is ignored) to CIE L*a*b*
+ */
+CieLab rgb_to_cielab(QRgb rgb);
+
+/**
+ * \brief Runs \p func on contiguous sub-ranges of [0, size) in parallel
+ *
+ * Ranges are dispatched to the global QThreadPool, the calling thread takes
+ * one of them and runs inline those that can't get a pool thread.
+ * Returns once all the ranges have been processed.
+ *
+ * \param min_chunk Minimum number of items in a range
+ */
+void parallel_for(int size, const std::function<void(int begin, int end)>& func,
+                  int min_chunk = 1);
+
+/**
+ * \brief Number of ranges parallel_for() splits \p size items into
+ */
+int parallel_chunks(int size, int min_chunk = 1);
+
+/**
+ * \brief Stable sort, chunks are sorted in parallel then merged pairwise
+ */
+template<class T, class Compare>
+void parallel_stable_sort(T* data, int size, Compare compare, int min_chunk = 4096)
+{
+    int chunks = parallel_chunks(size, min_chunk);
+    auto bound = [size, chunks](int chunk) {
+        return int(qint64(size) * chunk / chunks);
+    };
+
+    parallel_for(chunks, [&](int begin, int end) {
+        for ( int chunk = begin; chunk < end; chunk++ )
+            std::stable_sort(data + bound(chunk), data + bound(chunk + 1), compare);
+    });
+
+    for ( int width = 1; width < chunks; width *= 2 )
+    {
+        int pairs = (chunks + 2 * width - 1) / (2 * width);
+        parallel_for(pairs, [&](int begin, int end) {
+            for ( int pair = begin; pair < end; pair++ )
+            {
+                int first = pair * 2 * width;
+                int middle = qMin(first + width, chunks);
+                int last = qMin(first + 2 * width, chunks);
+                std::inplace_merge(data + bound(first), data + bound(middle),
+                                   data + bound(last), compare);
+            }
+        });
+    }
+}
+
 } // namespace detail
 } // namespace color_widgets
+
+#endif // COLOR_WIDGETS_COLOR_UTILS_HPP
@@ -27,7 +27,11 @@
 #include <QLineF>
 #include <QDragEnterEvent>
 #include <QMimeData>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "color_utils.hpp"
+#include "emission_throttle.hpp"
+#include "hue_ring.hpp"
 
 namespace color_widgets {
 
@@ -41,6 +45,8 @@ enum MouseStatus
 static const ColorWheel::DisplayFlags hard_default_flags = ColorWheel::SHAPE_TRIANGLE|ColorWheel::ANGLE_ROTATING|ColorWheel::COLOR_HSV;
 static ColorWheel::DisplayFlags default_flags = hard_default_flags;
 static const double selector_radius = 6;
+/// Milliseconds without hue changes before the selector is rendered at full resolution
+static const int refine_delay = 150;
 
 class ColorWheel::Private
 {
@@ -52,21 +58,87 @@ public:
     bool backgroundIsDark;
     unsigned int wheel_width;
     MouseStatus mouse_status;
-    QPixmap hue_ring;
+    QImage hue_ring;
     QImage inner_selector;
+    /// Ring, hue line and inner selector, everything but the handle
+    QImage composite;
     DisplayFlags display_flags;
     QColor (*color_from)(qreal,qreal,qreal,qreal);
     QColor (*rainbow_from_hue)(qreal);
-    int max_size = 128;
+    /// Maximum size of inner_selector while the hue is changing, 0 for no limit
+    int drag_resolution = 128;
+    /// Maximum size of inner_selector at rest, 0 for no limit
+    int idle_resolution = 0;
+    /// Whether inner_selector is smaller than idle_resolution allows
+    bool selector_reduced = false;
+    QElapsedTimer last_render;
+    QTimer refine_timer;
+    /// Milliseconds after the last resize before rendering at the new size
+    int resize_delay = 100;
+    QTimer resize_timer;
+    /// Color from hue, sat and val, updated by update_color()
+    CachedColor current;
+    EmissionPolicy emission_policy = EmitImmediately;
+    int emission_rate = 30;
+    detail::EmissionThrottle emission;
 
     Private(ColorWheel *widget)
         : w(widget), hue(0), sat(0), val(0),
         wheel_width(20), mouse_status(Nothing),
         display_flags(FLAGS_DEFAULT),
-        color_from(&QColor::fromHsvF), rainbow_from_hue(&detail::rainbow_hsv)
+        color_from(&QColor::fromHsvF), rainbow_from_hue(&detail::rainbow_hsv),
+        emission([this]{ emit_color(); })
     {
         qreal backgroundValue = widget->palette().background().color().valueF();
         backgroundIsDark = backgroundValue < 0.5;
+        update_color();
+
+        refine_timer.setSingleShot(true);
+        QObject::connect(&refine_timer, &QTimer::timeout, [this]{ refine_inner_selector(); });
+
+        resize_timer.setSingleShot(true);
+        QObject::connect(&resize_timer, &QTimer::timeout, [this]{
+            finish_resize();
+            w->update();
+        });
+    }
+
+    /// Renders the layers that depend on the widget size
+    void finish_resize()
+    {
+        resize_timer.stop();
+        render_ring();
+        render_inner_selector();
+    }
+
+    /// Must be called after changing hue, sat, val or color_from
+    void update_color()
+    {
+        current.setColor(color_from(hue, sat, val, 1));
+    }
+
+    /// Emits the signals for a color selected by the user
+    void emit_color()
+    {
+        QColor col = current.color();
+        Q_EMIT w->colorSelected(col);
+        Q_EMIT w->colorChanged(col);
+    }
+
+    void update_emission_interval()
+    {
+        switch ( emission_policy )
+        {
+            case EmitImmediately:
+                emission.setInterval(0);
+                break;
+            case EmitPerFrame:
+                emission.setInterval(detail::frame_interval(w));
+                break;
+            case EmitRateLimited:
+                emission.setInterval(1000 / emission_rate);
+                break;
+        }
     }
 
     /// Calculate outer wheel radius from idget center
@@ -105,60 +177,104 @@ public:
         return QLineF (w->geometry().width()/2, w->geometry().height()/2, p.x(), p.y());
     }
 
-    void render_square()
+    void render_square(const QSize& size)
     {
-        int width = qMin<int>(square_size(), max_size);
-        QSize size(width, width);
+        int width = size.width();
         inner_selector = QImage(size, QImage::Format_RGB32);
+        uchar* bits = inner_selector.bits();
+        int stride = inner_selector.bytesPerLine();
 
-        for ( int y = 0; y < width; ++y )
-        {
-            for ( int x = 0; x < width; ++x )
+        detail::parallel_for(width, [&](int begin, int end) {
+            for ( int y = begin; y < end; ++y )
             {
-                inner_selector.setPixel( x, y,
-                        color_from(hue,double(x)/width,double(y)/width,1).rgb());
+                QRgb* line = reinterpret_cast<QRgb*>(bits + y * stride);
+                for ( int x = 0; x < width; ++x )
+                    line[x] = color_from(hue,double(x)/width,double(y)/width,1).rgb();
             }
-        }
+        }, 16);
     }
 
     /**
      * \brief renders the selector as a triangle
      * \note It's the same as a square with the edge with value=0 collapsed to a single point
      */
-    void render_triangle()
+    void render_triangle(const QSize& pixel_size)
     {
-        QSizeF size = selector_size();
-        if ( size.height() > max_size )
-            size *= max_size / size.height();
-
+        QSizeF size = pixel_size;
         qreal ycenter = size.height()/2;
-        inner_selector = QImage(size.toSize(), QImage::Format_RGB32);
+        inner_selector = QImage(pixel_size, QImage::Format_RGB32);
+        uchar* bits = inner_selector.bits();
+        int stride = inner_selector.bytesPerLine();
+        int width = inner_selector.width();
 
-        for (int x = 0; x < inner_selector.width(); x++ )
-        {
-            qreal pval = x / size.height();
-            qreal slice_h = size.height() * pval;
-            for (int y = 0; y < inner_selector.height(); y++ )
+        detail::parallel_for(inner_selector.height(), [&](int begin, int end) {
+            for (int y = begin; y < end; y++ )
             {
-                qreal ymin = ycenter-slice_h/2;
-                qreal psat = qBound(0.0,(y-ymin)/slice_h,1.0);
-
-                inner_selector.setPixel(x,y,color_from(hue,psat,pval,1).rgb());
+                QRgb* line = reinterpret_cast<QRgb*>(bits + y * stride);
+                for (int x = 0; x < width; x++ )
+                {
+                    qreal pval = x / size.height();
+                    qreal slice_h = size.height() * pval;
+                    qreal ymin = ycenter-slice_h/2;
+                    qreal psat = qBound(0.0,(y-ymin)/slice_h,1.0);
+
+                    line[x] = color_from(hue,psat,pval,1).rgb();
+                }
             }
-        }
+        }, 16);
+    }
+
+    /**
+     * \brief Size in device pixels of the inner selector image
+     * \param budget Maximum size of the longest side, 0 for no limit
+     */
+    QSize selector_pixel_size(int budget) const
+    {
+        QSizeF size = selector_size() * w->devicePixelRatioF();
+        qreal longest = qMax(size.width(), size.height());
+        if ( budget > 0 && longest > budget )
+            size *= budget / longest;
+        return size.toSize().expandedTo(QSize(1, 1));
     }
 
     /// Updates the inner image that displays the saturation-value selector
     void render_inner_selector()
     {
+        // Renders in quick succession come from hue drags, on the wheel or
+        // on a linked widget, they use the drag budget until things settle
+        bool busy = mouse_status == DragCircle ||
+            (last_render.isValid() && last_render.elapsed() < refine_delay);
+        last_render.start();
+
+        render_inner_selector(busy ? drag_resolution : idle_resolution);
+        if ( selector_reduced )
+            refine_timer.start(refine_delay);
+    }
+
+    void render_inner_selector(int budget)
+    {
+        QSize size = selector_pixel_size(budget);
         if ( display_flags & ColorWheel::SHAPE_TRIANGLE )
-            render_triangle();
+            render_triangle(size);
         else
-            render_square();
+            render_square(size);
+        selector_reduced = size != selector_pixel_size(idle_resolution);
+        composite = QImage();
+    }
+
+    /// Renders the inner selector at full resolution if it isn't already
+    void refine_inner_selector()
+    {
+        refine_timer.stop();
+        if ( selector_reduced )
+        {
+            render_inner_selector(idle_resolution);
+            w->update();
+        }
     }
 
     /// Offset of the selector image
-    QPointF selector_image_offset()
+    QPointF selector_image_offset() const
     {
         if ( display_flags & SHAPE_TRIANGLE )
                 return QPointF(-inner_radius(),-triangle_side()/2);
@@ -168,7 +284,7 @@ public:
     /**
      * \brief Size of the selector when rendered to the screen
      */
-    QSizeF selector_size()
+    QSizeF selector_size() const
     {
         if ( display_flags & SHAPE_TRIANGLE )
                 return QSizeF(triangle_height(), triangle_side());
@@ -177,7 +293,7 @@ public:
 
 
     /// Rotation of the selector image
-    qreal selector_image_angle()
+    qreal selector_image_angle() const
     {
         if ( display_flags & SHAPE_TRIANGLE )
         {
@@ -194,38 +310,127 @@ public:
         }
     }
 
-    /// Updates the outer ring that displays the hue selector
-    void render_ring()
+    /// Position of the saturation/value handle on the selector image
+    QPointF selector_position() const
     {
-        hue_ring = QPixmap(outer_radius()*2,outer_radius()*2);
-        hue_ring.fill(Qt::transparent);
-        QPainter painter(&hue_ring);
-        painter.setRenderHint(QPainter::Antialiasing);
-        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        if ( display_flags & SHAPE_SQUARE )
+        {
+            qreal side = square_size();
+            return QPointF(sat*side, val*side);
+        }
+
+        qreal side = triangle_side();
+        qreal slice_h = side * val;
+        qreal ymin = side/2-slice_h/2;
+        return QPointF(val*triangle_height(), ymin + sat*slice_h);
+    }
 
+    /// Maps selector image coordinates to widget coordinates
+    QTransform selector_transform() const
+    {
+        QTransform transform;
+        transform.translate(w->geometry().width()/2, w->geometry().height()/2);
+        transform.rotate(selector_image_angle());
+        transform.translate(selector_image_offset().x(), selector_image_offset().y());
+        return transform;
+    }
+
+    /// Area covered by the saturation/value handle
+    QRect handle_rect() const
+    {
+        // Accounts for the pen width and antialiasing
+        qreal radius = selector_radius + 3;
+        QPointF center = selector_transform().map(selector_position());
+        return QRectF(center.x() - radius, center.y() - radius, radius*2, radius*2)
+            .toAlignedRect();
+    }
+
+    /// Area affected by a change of hue: the hue line, the inner selector and its handle
+    QRegion hue_region() const
+    {
+        QPointF center(w->geometry().width()/2, w->geometry().height()/2);
+        QLineF ray(center, center + QPointF(outer_radius(), 0));
+        ray.setAngle(hue*360);
+        QPointF outer = ray.p2();
+        ray.setLength(inner_radius());
+        QRectF line = QRectF(outer, ray.p2()).normalized().adjusted(-3, -3, 3, 3);
+
+        qreal radius = inner_radius();
+        QRectF inner(center.x() - radius, center.y() - radius, radius*2, radius*2);
+
+        return QRegion(line.toAlignedRect())
+            .united(inner.toAlignedRect())
+            .united(handle_rect());
+    }
 
-        const int hue_stops = 24;
-        QConicalGradient gradient_hue(0, 0, 0);
-        if ( gradient_hue.stops().size() < hue_stops )
+    /**
+     * \brief Draws the layers that don't depend on saturation and value
+     *
+     * They only change with the hue, the display flags or the size, so
+     * handle drags just blit the result.
+     */
+    void render_composite(qreal dpr)
+    {
+        if(hue_ring.isNull() || hue_ring.devicePixelRatio() != dpr)
         {
-            for ( double a = 0; a < 1.0; a+=1.0/(hue_stops-1) )
-            {
-                gradient_hue.setColorAt(a,rainbow_from_hue(a));
-            }
-            gradient_hue.setColorAt(1,rainbow_from_hue(0));
+            // Moved to a screen with a different pixel density
+            render_ring();
+            inner_selector = QImage();
         }
+        if(inner_selector.isNull())
+            render_inner_selector();
 
-        painter.translate(outer_radius(),outer_radius());
+        composite = QImage(w->size() * dpr, QImage::Format_ARGB32_Premultiplied);
+        composite.setDevicePixelRatio(dpr);
+        composite.fill(Qt::transparent);
 
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(QBrush(gradient_hue));
-        painter.drawEllipse(QPointF(0,0),outer_radius(),outer_radius());
+        QPainter painter(&composite);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.translate(w->geometry().width()/2,w->geometry().height()/2);
+
+        // hue wheel
+        painter.drawImage(QPointF(-outer_radius(), -outer_radius()), hue_ring);
+
+        // hue selector
+        painter.setPen(QPen(Qt::black,3));
+        painter.setBrush(Qt::NoBrush);
+        QLineF ray(0, 0, outer_radius(), 0);
+        ray.setAngle(hue*360);
+        QPointF h1 = ray.p2();
+        ray.setLength(inner_radius());
+        QPointF h2 = ray.p2();
+        painter.drawLine(h1,h2);
+
+        // lum-sat square
+        painter.rotate(selector_image_angle());
+        painter.translate(selector_image_offset());
 
-        painter.setBrush(Qt::transparent);//palette().background());
-        painter.drawEllipse(QPointF(0,0),inner_radius(),inner_radius());
+        if ( display_flags & SHAPE_TRIANGLE )
+        {
+            qreal side = triangle_side();
+            qreal height = triangle_height();
+            QPolygonF triangle;
+            triangle.append(QPointF(0,side/2));
+            triangle.append(QPointF(height,0));
+            triangle.append(QPointF(height,side));
+            QPainterPath clip;
+            clip.addPolygon(triangle);
+            painter.setClipPath(clip);
+        }
+
+        painter.drawImage(QRectF(QPointF(0, 0), selector_size()), inner_selector);
+    }
+
+    /// Updates the outer ring that displays the hue selector
+    void render_ring()
+    {
+        composite = QImage();
+        hue_ring = detail::hue_ring_image(outer_radius(), inner_radius(),
+                                          rainbow_from_hue, w->devicePixelRatioF());
     }
 
-    void set_color(const QColor& c)
+    void set_color(const CachedColor& c)
     {
         if ( display_flags & ColorWheel::COLOR_HSV )
         {
@@ -235,16 +440,17 @@ public:
         }
         else if ( display_flags & ColorWheel::COLOR_HSL )
         {
-            hue = qMax(0.0, c.hueF());
-            sat = detail::color_HSL_saturationF(c);
-            val = detail::color_lightnessF(c);
+            hue = qMax(0.0, c.hsvHueF());
+            sat = c.hslSaturationF();
+            val = c.lightnessF();
         }
         else if ( display_flags & ColorWheel::COLOR_LCH )
         {
             hue = qMax(0.0, c.hsvHueF());
-            sat = detail::color_chromaF(c);
-            val = detail::color_lumaF(c);
+            sat = c.chromaF();
+            val = c.lumaF();
         }
+        update_color();
     }
 };
 
@@ -262,7 +468,12 @@ ColorWheel::~ColorWheel()
 
 QColor ColorWheel::color() const
 {
-    return p->color_from(p->hue, p->sat, p->val, 1);
+    return p->current.color();
+}
+
+const CachedColor& ColorWheel::cachedColor() const
+{
+    return p->current;
 }
 
 QSize ColorWheel::sizeHint() const
@@ -273,18 +484,18 @@ QSize ColorWheel::sizeHint() const
 qreal ColorWheel::hue() const
 {
     if ( (p->display_flags & COLOR_LCH) && p->sat > 0.01 )
-        return color().hueF();
+        return p->current.hsvHueF();
     return p->hue;
 }
 
 qreal ColorWheel::saturation() const
 {
-    return color().hsvSaturationF();
+    return p->current.hsvSaturationF();
 }
 
 qreal ColorWheel::value() const
 {
-    return color().valueF();
+    return p->current.valueF();
 }
 
 unsigned int ColorWheel::wheelWidth() const
@@ -302,61 +513,36 @@ void ColorWheel::setWheelWidth(unsigned int w)
 void ColorWheel::paintEvent(QPaintEvent * )
 {
     QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
-    painter.translate(geometry().width()/2,geometry().height()/2);
-
-    // hue wheel
-    if(p->hue_ring.isNull())
-        p->render_ring();
-
-    painter.drawPixmap(-p->outer_radius(), -p->outer_radius(), p->hue_ring);
-
-    // hue selector
-    painter.setPen(QPen(Qt::black,3));
-    painter.setBrush(Qt::NoBrush);
-    QLineF ray(0, 0, p->outer_radius(), 0);
-    ray.setAngle(p->hue*360);
-    QPointF h1 = ray.p2();
-    ray.setLength(p->inner_radius());
-    QPointF h2 = ray.p2();
-    painter.drawLine(h1,h2);
-
-    // lum-sat square
-    if(p->inner_selector.isNull())
-        p->render_inner_selector();
 
-    painter.rotate(p->selector_image_angle());
-    painter.translate(p->selector_image_offset());
-
-    QPointF selector_position;
-    if ( p->display_flags & SHAPE_SQUARE )
+    if ( p->resize_timer.isActive() && !p->composite.isNull() )
     {
-        qreal side = p->square_size();
-        selector_position = QPointF(p->sat*side, p->val*side);
+        // Still resizing, the old layers are scaled to fit in the meantime
+        QSizeF old_size = QSizeF(p->composite.size()) / p->composite.devicePixelRatio();
+        qreal scale = qMin(width(), height()) / qMax(1.0, qMin(old_size.width(), old_size.height()));
+        QSizeF target = old_size * scale;
+        QPointF origin((width() - target.width()) / 2, (height() - target.height()) / 2);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(QRectF(origin, target), p->composite);
     }
-    else if ( p->display_flags & SHAPE_TRIANGLE )
+    else
     {
-        qreal side = p->triangle_side();
-        qreal height = p->triangle_height();
-        qreal slice_h = side * p->val;
-        qreal ymin = side/2-slice_h/2;
+        // The layers have been invalidated by something else during a resize
+        if ( p->resize_timer.isActive() )
+            p->finish_resize();
 
-        selector_position = QPointF(p->val*height, ymin + p->sat*slice_h);
-        QPolygonF triangle;
-        triangle.append(QPointF(0,side/2));
-        triangle.append(QPointF(height,0));
-        triangle.append(QPointF(height,side));
-        QPainterPath clip;
-        clip.addPolygon(triangle);
-        painter.setClipPath(clip);
-    }
+        qreal dpr = devicePixelRatioF();
+        if ( p->composite.isNull() || p->composite.devicePixelRatio() != dpr ||
+             p->composite.size() != size() * dpr )
+            p->render_composite(dpr);
 
-    painter.drawImage(QRectF(QPointF(0, 0), p->selector_size()), p->inner_selector);
-    painter.setClipping(false);
+        painter.drawImage(0, 0, p->composite);
+    }
 
     // lum-sat selector
     // we define the color of the selecto based on the background color of the widget
     // in order to improve to contrast
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setTransform(p->selector_transform());
     if (p->backgroundIsDark)
     {
         bool isWhite = (p->val < 0.65 || p->sat > 0.43);
@@ -367,23 +553,24 @@ void ColorWheel::paintEvent(QPaintEvent * )
         painter.setPen(QPen(p->val > 0.5 ? Qt::black : Qt::white, 3));
     }
     painter.setBrush(Qt::NoBrush);
-    painter.drawEllipse(selector_position, selector_radius, selector_radius);
-
+    painter.drawEllipse(p->selector_position(), selector_radius, selector_radius);
 }
 
 void ColorWheel::mouseMoveEvent(QMouseEvent *ev)
 {
     if (p->mouse_status == DragCircle )
     {
+        QRegion dirty = p->hue_region();
         p->hue = p->line_to_point(ev->pos()).angle()/360.0;
+        p->update_color();
         p->render_inner_selector();
 
-        Q_EMIT colorSelected(color());
-        Q_EMIT colorChanged(color());
-        update();
+        p->emission.request();
+        update(dirty.united(p->hue_region()));
     }
     else if(p->mouse_status == DragSquare)
     {
+        QRect dirty = p->handle_rect();
         QLineF glob_mouse_ln = p->line_to_point(ev->pos());
         QLineF center_mouse_ln ( QPointF(0,0),
                                  glob_mouse_ln.p2() - glob_mouse_ln.p1() );
@@ -410,10 +597,10 @@ void ColorWheel::mouseMoveEvent(QMouseEvent *ev)
             if ( slice_h > 0 )
                 p->sat = qBound(0.0, (pt.y()-ymin)/slice_h, 1.0);
         }
+        p->update_color();
 
-        Q_EMIT colorSelected(color());
-        Q_EMIT colorChanged(color());
-        update();
+        p->emission.request();
+        update(QRegion(dirty).united(p->handle_rect()));
     }
 }
 
@@ -422,6 +609,7 @@ void ColorWheel::mousePressEvent(QMouseEvent *ev)
     if ( ev->buttons() & Qt::LeftButton )
     {
         setFocus();
+        p->update_emission_interval();
         QLineF ray = p->line_to_point(ev->pos());
         if ( ray.length() <= p->inner_radius() )
             p->mouse_status = DragSquare;
@@ -437,16 +625,21 @@ void ColorWheel::mouseReleaseEvent(QMouseEvent *ev)
 {
     mouseMoveEvent(ev);
     p->mouse_status = Nothing;
+    p->emission.flush();
+    p->refine_inner_selector();
 }
 
 void ColorWheel::resizeEvent(QResizeEvent *)
 {
-    p->render_ring();
-    p->render_inner_selector();
+    if ( p->resize_delay > 0 && !p->composite.isNull() )
+        p->resize_timer.start(p->resize_delay);
+    else
+        p->finish_resize();
 }
 
 void ColorWheel::setColor(QColor c)
 {
+    p->emission.cancel();
     qreal oldh = p->hue;
     p->set_color(c);
     if (!qFuzzyCompare(oldh+1, p->hue+1))
@@ -457,21 +650,29 @@ void ColorWheel::setColor(QColor c)
 
 void ColorWheel::setHue(qreal h)
 {
+    p->emission.cancel();
     p->hue = qBound(0.0, h, 1.0);
+    p->update_color();
     p->render_inner_selector();
     update();
 }
 
 void ColorWheel::setSaturation(qreal s)
 {
+    p->emission.cancel();
+    QRect dirty = p->handle_rect();
     p->sat = qBound(0.0, s, 1.0);
-    update();
+    p->update_color();
+    update(QRegion(dirty).united(p->handle_rect()));
 }
 
 void ColorWheel::setValue(qreal v)
 {
+    p->emission.cancel();
+    QRect dirty = p->handle_rect();
     p->val = qBound(0.0, v, 1.0);
-    update();
+    p->update_color();
+    update(QRegion(dirty).united(p->handle_rect()));
 }
 
 
@@ -486,20 +687,20 @@ void ColorWheel::setDisplayFlags(DisplayFlags flags)
 
     if ( (flags & COLOR_FLAGS) != (p->display_flags & COLOR_FLAGS) )
     {
-        QColor old_col = color();
+        const CachedColor& old_col = p->current;
         if ( flags & ColorWheel::COLOR_HSL )
         {
-            p->hue = old_col.hueF();
-            p->sat = detail::color_HSL_saturationF(old_col);
-            p->val = detail::color_lightnessF(old_col);
+            p->hue = old_col.hsvHueF();
+            p->sat = old_col.hslSaturationF();
+            p->val = old_col.lightnessF();
             p->color_from = &detail::color_from_hsl;
             p->rainbow_from_hue = &detail::rainbow_hsv;
         }
         else if ( flags & ColorWheel::COLOR_LCH )
         {
-            p->hue = old_col.hueF();
-            p->sat = detail::color_chromaF(old_col);
-            p->val = detail::color_lumaF(old_col);
+            p->hue = old_col.hsvHueF();
+            p->sat = old_col.chromaF();
+            p->val = old_col.lumaF();
             p->color_from = &detail::color_from_lch;
             p->rainbow_from_hue = &detail::rainbow_lch;
         }
@@ -511,6 +712,7 @@ void ColorWheel::setDisplayFlags(DisplayFlags flags)
             p->color_from = &QColor::fromHsvF;
             p->rainbow_from_hue = &detail::rainbow_hsv;
         }
+        p->update_color();
         p->render_ring();
     }
 
@@ -571,4 +773,88 @@ void ColorWheel::dropEvent(QDropEvent* event)
     }
 }
 
+ColorWheel::EmissionPolicy ColorWheel::emissionPolicy() const
+{
+    return p->emission_policy;
+}
+
+void ColorWheel::setEmissionPolicy(EmissionPolicy policy)
+{
+    if ( policy != p->emission_policy )
+    {
+        p->emission.flush();
+        p->emission_policy = policy;
+        p->update_emission_interval();
+        Q_EMIT emissionPolicyChanged(policy);
+    }
+}
+
+int ColorWheel::emissionRate() const
+{
+    return p->emission_rate;
+}
+
+void ColorWheel::setEmissionRate(int rate)
+{
+    rate = qBound(1, rate, 1000);
+    if ( rate != p->emission_rate )
+    {
+        p->emission_rate = rate;
+        p->update_emission_interval();
+        Q_EMIT emissionRateChanged(rate);
+    }
+}
+
+int ColorWheel::selectorDragResolution() const
+{
+    return p->drag_resolution;
+}
+
+void ColorWheel::setSelectorDragResolution(int resolution)
+{
+    resolution = qMax(0, resolution);
+    if ( resolution != p->drag_resolution )
+    {
+        p->drag_resolution = resolution;
+        Q_EMIT selectorDragResolutionChanged(resolution);
+    }
+}
+
+int ColorWheel::selectorIdleResolution() const
+{
+    return p->idle_resolution;
+}
+
+void ColorWheel::setSelectorIdleResolution(int resolution)
+{
+    resolution = qMax(0, resolution);
+    if ( resolution != p->idle_resolution )
+    {
+        p->idle_resolution = resolution;
+        p->render_inner_selector(resolution);
+        update();
+        Q_EMIT selectorIdleResolutionChanged(resolution);
+    }
+}
+
+int ColorWheel::resizeDelay() const
+{
+    return p->resize_delay;
+}
+
+void ColorWheel::setResizeDelay(int msec)
+{
+    msec = qMax(0, msec);
+    if ( msec != p->resize_delay )
+    {
+        p->resize_delay = msec;
+        if ( msec == 0 && p->resize_timer.isActive() )
+        {
+            p->finish_resize();
+            update();
+        }
+        Q_EMIT resizeDelayChanged(msec);
+    }
+}
+
 } //  namespace color_widgets
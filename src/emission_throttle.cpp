@@ -0,0 +1,102 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "emission_throttle.hpp"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWidget>
+#include <QWindow>
+
+namespace color_widgets {
+namespace detail {
+
+EmissionThrottle::EmissionThrottle(const std::function<void()>& emitter)
+    : emitter(emitter)
+{
+    timer.setSingleShot(true);
+    QObject::connect(&timer, &QTimer::timeout, [this]{ fire(); });
+}
+
+int EmissionThrottle::interval() const
+{
+    return interval_msec;
+}
+
+void EmissionThrottle::setInterval(int msec)
+{
+    interval_msec = qMax(0, msec);
+}
+
+void EmissionThrottle::request()
+{
+    if ( interval_msec == 0 )
+    {
+        timer.stop();
+        fire();
+        return;
+    }
+
+    if ( timer.isActive() )
+        return;
+
+    // Even when the interval has already passed the emission goes through the
+    // event loop, so mouse moves queued behind a slow listener get merged
+    qint64 elapsed = last_emission.isValid() ? last_emission.elapsed() : interval_msec;
+    timer.start(int(qMax<qint64>(0, interval_msec - elapsed)));
+}
+
+void EmissionThrottle::flush()
+{
+    if ( timer.isActive() )
+    {
+        timer.stop();
+        fire();
+    }
+}
+
+void EmissionThrottle::cancel()
+{
+    timer.stop();
+}
+
+void EmissionThrottle::fire()
+{
+    last_emission.start();
+    emitter();
+}
+
+int frame_interval(const QWidget* widget)
+{
+    QScreen* screen = nullptr;
+    if ( widget && widget->window()->windowHandle() )
+        screen = widget->window()->windowHandle()->screen();
+    if ( !screen )
+        screen = QGuiApplication::primaryScreen();
+
+    qreal rate = screen ? screen->refreshRate() : 0;
+    if ( rate <= 0 )
+        rate = 60;
+    return qMax(1, qRound(1000 / rate));
+}
+
+} // namespace detail
+} // namespace color_widgets
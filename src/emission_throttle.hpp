@@ -0,0 +1,91 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_EMISSION_THROTTLE_HPP
+#define COLOR_WIDGETS_EMISSION_THROTTLE_HPP
+
+#include <functional>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QWidget;
+
+namespace color_widgets {
+namespace detail {
+
+/**
+ * \brief Coalesces frequent signal emissions
+ *
+ * Requests made while an emission is pending are merged into it, and
+ * emissions are spaced by at least interval() milliseconds.
+ * Pending emissions are delivered from the event loop, after the input
+ * events that are already queued.
+ */
+class EmissionThrottle
+{
+public:
+    /**
+     * \param emitter Called to perform the emission, it should read the
+     *                current state rather than the one at request time
+     */
+    explicit EmissionThrottle(const std::function<void()>& emitter);
+
+    /**
+     * \brief Minimum time between emissions, 0 to emit synchronously
+     */
+    int interval() const;
+    void setInterval(int msec);
+
+    /**
+     * \brief Requests an emission
+     */
+    void request();
+
+    /**
+     * \brief Performs the pending emission right away, if any
+     */
+    void flush();
+
+    /**
+     * \brief Drops the pending emission, if any
+     *
+     * For when the state is replaced by something the emission shouldn't report.
+     */
+    void cancel();
+
+private:
+    void fire();
+
+    std::function<void()> emitter;
+    QTimer timer;
+    QElapsedTimer last_emission;
+    int interval_msec = 0;
+};
+
+/**
+ * \brief Duration of a frame in milliseconds on the screen showing \p widget
+ */
+int frame_interval(const QWidget* widget);
+
+} // namespace detail
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_EMISSION_THROTTLE_HPP
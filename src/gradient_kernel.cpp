@@ -0,0 +1,298 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "gradient_kernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "color_utils.hpp"
+
+namespace color_widgets {
+namespace detail {
+
+namespace {
+
+/// Below this OKLCh chroma the hue is meaningless
+const float achromatic_chroma = 1e-4f;
+
+/**
+ * \brief Index of the hue component, -1 for spaces without one
+ */
+int hue_component(GradientSlider::Interpolation interpolation)
+{
+    switch ( interpolation )
+    {
+        case GradientSlider::InterpolateHsvShorter:
+        case GradientSlider::InterpolateHsvLonger:
+            return 0;
+        case GradientSlider::InterpolateOklch:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * \brief Converts \p color to the interpolation space
+ * \returns Whether the color has a meaningful hue
+ */
+bool to_space(const QColor& color, GradientSlider::Interpolation interpolation, float* out)
+{
+    out[3] = color.alphaF();
+    switch ( interpolation )
+    {
+        case GradientSlider::InterpolateRgb:
+            out[0] = color.redF();
+            out[1] = color.greenF();
+            out[2] = color.blueF();
+            return false;
+        case GradientSlider::InterpolateLinearRgb:
+            out[0] = srgb8_to_linear(color.red());
+            out[1] = srgb8_to_linear(color.green());
+            out[2] = srgb8_to_linear(color.blue());
+            return false;
+        case GradientSlider::InterpolateHsvShorter:
+        case GradientSlider::InterpolateHsvLonger:
+        {
+            qreal hue = color.hsvHueF();
+            out[0] = qMax(hue, qreal(0));
+            out[1] = color.hsvSaturationF();
+            out[2] = color.valueF();
+            return hue >= 0;
+        }
+        case GradientSlider::InterpolateOklab:
+        {
+            Oklab lab = rgb_to_oklab(color.rgb());
+            out[0] = lab.l;
+            out[1] = lab.a;
+            out[2] = lab.b;
+            return false;
+        }
+        case GradientSlider::InterpolateOklch:
+        {
+            Oklab lab = rgb_to_oklab(color.rgb());
+            float hue = std::atan2(lab.b, lab.a) / float(2 * M_PI);
+            out[0] = lab.l;
+            out[1] = std::sqrt(lab.a * lab.a + lab.b * lab.b);
+            out[2] = hue < 0 ? hue + 1 : hue;
+            return out[1] > achromatic_chroma;
+        }
+    }
+    return false;
+}
+
+int unit_to_8bit(float c)
+{
+    return qBound(0, int(c * 255 + 0.5f), 255);
+}
+
+QRgb hsv_to_rgb(float hue, float sat, float val)
+{
+    float h6 = (hue - std::floor(hue)) * 6;
+    int sector = int(h6) % 6;
+    float f = h6 - int(h6);
+    float p = val * (1 - sat);
+    float q = val * (1 - sat * f);
+    float t = val * (1 - sat * (1 - f));
+    float r, g, b;
+    switch ( sector )
+    {
+        case 0:  r = val; g = t;   b = p;   break;
+        case 1:  r = q;   g = val; b = p;   break;
+        case 2:  r = p;   g = val; b = t;   break;
+        case 3:  r = p;   g = q;   b = val; break;
+        case 4:  r = t;   g = p;   b = val; break;
+        default: r = val; g = p;   b = q;   break;
+    }
+    return qRgb(unit_to_8bit(r), unit_to_8bit(g), unit_to_8bit(b));
+}
+
+} // namespace
+
+GradientKernel::GradientKernel(const QGradientStops& stops,
+                               GradientSlider::Interpolation interpolation)
+    : interpolation(interpolation)
+{
+    if ( stops.isEmpty() )
+        return;
+
+    QGradientStops sorted = stops;
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const QGradientStop& a, const QGradientStop& b) {
+            return a.first < b.first;
+        });
+
+    int hue = hue_component(interpolation);
+    int count = qMax(1, sorted.size() - 1);
+    segments.resize(count);
+    for ( int i = 0; i < count; i++ )
+    {
+        const QGradientStop& from = sorted[i];
+        const QGradientStop& to = sorted[qMin(i + 1, sorted.size() - 1)];
+        Segment& segment = segments[i];
+        segment.start_pos = from.first;
+        segment.end_pos = to.first;
+        segment.start_rgb = from.second.rgba();
+        segment.end_rgb = to.second.rgba();
+        bool start_hue = to_space(from.second, interpolation, segment.start);
+        bool end_hue = to_space(to.second, interpolation, segment.end);
+
+        if ( hue != -1 )
+        {
+            // A color without hue takes the hue of the other end
+            float& h0 = segment.start[hue];
+            float& h1 = segment.end[hue];
+            if ( !start_hue )
+                h0 = h1;
+            else if ( !end_hue )
+                h1 = h0;
+
+            float delta = h1 - h0;
+            if ( interpolation == GradientSlider::InterpolateHsvLonger )
+            {
+                if ( start_hue && end_hue && delta > 0 && delta < 0.5f )
+                    h0 += 1;
+                else if ( start_hue && end_hue && delta < 0 && delta > -0.5f )
+                    h1 += 1;
+            }
+            else
+            {
+                if ( delta > 0.5f )
+                    h0 += 1;
+                else if ( delta < -0.5f )
+                    h1 += 1;
+            }
+        }
+
+        // Fading colors are interpolated premultiplied (as QGradient does),
+        // hues are left alone
+        segment.premultiplied = segment.start[3] != segment.end[3];
+        if ( segment.premultiplied )
+        {
+            for ( int c = 0; c < 3; c++ )
+            {
+                if ( c != hue )
+                {
+                    segment.start[c] *= segment.start[3];
+                    segment.end[c] *= segment.end[3];
+                }
+            }
+        }
+    }
+}
+
+int GradientKernel::find_segment(float t) const
+{
+    auto it = std::lower_bound(segments.begin(), segments.end(), t,
+        [](const Segment& segment, float t) {
+            return segment.end_pos < t;
+        });
+    if ( it == segments.end() )
+        return segments.size() - 1;
+    return it - segments.begin();
+}
+
+QRgb GradientKernel::evaluate(const Segment& segment, float t) const
+{
+    float span = segment.end_pos - segment.start_pos;
+    float weight = span > 0 ? (t - segment.start_pos) / span : 1;
+    if ( weight <= 0 )
+        return segment.start_rgb;
+    if ( weight >= 1 )
+        return segment.end_rgb;
+
+    float c[4];
+    for ( int i = 0; i < 4; i++ )
+        c[i] = segment.start[i] + (segment.end[i] - segment.start[i]) * weight;
+
+    float alpha = c[3];
+    if ( segment.premultiplied && alpha > 0 )
+    {
+        int hue = hue_component(interpolation);
+        for ( int i = 0; i < 3; i++ )
+            if ( i != hue )
+                c[i] /= alpha;
+    }
+
+    QRgb rgb;
+    switch ( interpolation )
+    {
+        case GradientSlider::InterpolateRgb:
+            rgb = qRgb(unit_to_8bit(c[0]), unit_to_8bit(c[1]), unit_to_8bit(c[2]));
+            break;
+        case GradientSlider::InterpolateLinearRgb:
+            rgb = qRgb(linear_to_srgb8(c[0]), linear_to_srgb8(c[1]), linear_to_srgb8(c[2]));
+            break;
+        case GradientSlider::InterpolateHsvShorter:
+        case GradientSlider::InterpolateHsvLonger:
+            rgb = hsv_to_rgb(c[0], qBound(0.f, c[1], 1.f), qBound(0.f, c[2], 1.f));
+            break;
+        case GradientSlider::InterpolateOklab:
+            rgb = oklab_to_rgb(Oklab{c[0], c[1], c[2]});
+            break;
+        case GradientSlider::InterpolateOklch:
+        default:
+        {
+            float angle = c[2] * float(2 * M_PI);
+            rgb = oklab_to_rgb(Oklab{c[0], c[1] * std::cos(angle), c[1] * std::sin(angle)});
+            break;
+        }
+    }
+
+    return (rgb & RGB_MASK) | (QRgb(unit_to_8bit(alpha)) << 24);
+}
+
+QRgb GradientKernel::sample(qreal t) const
+{
+    if ( segments.isEmpty() )
+        return 0;
+    return evaluate(segments[find_segment(t)], t);
+}
+
+void GradientKernel::render(QRgb* output, int count, qreal first, qreal step) const
+{
+    if ( segments.isEmpty() )
+    {
+        std::fill(output, output + count, QRgb(0));
+        return;
+    }
+
+    parallel_for(count, [this, output, first, step](int begin, int end) {
+        int segment = find_segment(first + step * begin);
+        for ( int i = begin; i < end; i++ )
+        {
+            float t = first + step * i;
+            if ( step >= 0 )
+            {
+                while ( segment + 1 < segments.size() && segments[segment].end_pos < t )
+                    segment++;
+            }
+            else
+            {
+                segment = find_segment(t);
+            }
+            output[i] = evaluate(segments[segment], t);
+        }
+    }, 4096);
+}
+
+} // namespace detail
+} // namespace color_widgets
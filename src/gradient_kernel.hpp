@@ -0,0 +1,80 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_GRADIENT_KERNEL_HPP
+#define COLOR_WIDGETS_GRADIENT_KERNEL_HPP
+
+#include <QGradient>
+#include <QVector>
+#include "gradient_slider.hpp"
+
+namespace color_widgets {
+namespace detail {
+
+/**
+ * \brief Evaluates gradient stops in a given color space
+ *
+ * The stops are converted once on construction, sampling only interpolates
+ * between the two surrounding stops and converts the result back to sRGB.
+ * Positions outside the stops take the color of the nearest stop.
+ */
+class GradientKernel
+{
+public:
+    GradientKernel() = default;
+    GradientKernel(const QGradientStops& stops,
+                   GradientSlider::Interpolation interpolation);
+
+    /**
+     * \brief Color at \p t, non-premultiplied
+     */
+    QRgb sample(qreal t) const;
+
+    /**
+     * \brief Writes the colors at \p first, \p first + \p step, ... to \p output
+     *
+     * Long outputs are split between threads.
+     */
+    void render(QRgb* output, int count, qreal first, qreal step) const;
+
+    bool isEmpty() const { return segments.isEmpty(); }
+
+private:
+    /// Interpolation between two stops, colors in the interpolation space
+    struct Segment
+    {
+        float start_pos, end_pos;
+        float start[4], end[4];
+        QRgb start_rgb, end_rgb;
+        bool premultiplied;
+    };
+
+    int find_segment(float t) const;
+    QRgb evaluate(const Segment& segment, float t) const;
+
+    QVector<Segment> segments;
+    GradientSlider::Interpolation interpolation = GradientSlider::InterpolateRgb;
+};
+
+} // namespace detail
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_GRADIENT_KERNEL_HPP
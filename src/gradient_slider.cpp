@@ -25,6 +25,8 @@
 #include <QPainter>
 #include <QStyleOptionSlider>
 #include <QLinearGradient>
+#include <QImage>
+#include "gradient_kernel.hpp"
 
 static void loadResource()
 {
@@ -43,6 +45,15 @@ class GradientSlider::Private
 public:
     QLinearGradient gradient;
     QBrush back;
+    Interpolation interpolation = InterpolateRgb;
+    /// Stops converted for interpolation, built on demand
+    mutable detail::GradientKernel kernel;
+    mutable bool kernel_outdated = true;
+    /// Background and gradient, rendered by render_strip()
+    QImage strip;
+    Qt::Orientation strip_orientation = Qt::Horizontal;
+    /// Area covered by the handle the last time it was painted
+    QRect handle_rect;
 
     Private() :
         back(Qt::darkGray, Qt::DiagCrossPattern)
@@ -52,6 +63,72 @@ public:
         gradient.setCoordinateMode(QGradient::StretchToDeviceMode);
     }
 
+    /**
+     * \brief Whether the strip has to be rendered again
+     */
+    bool strip_outdated(const QSize& size, qreal dpr, Qt::Orientation orientation) const
+    {
+        return strip.isNull() || strip.devicePixelRatio() != dpr ||
+               strip.size() != size * dpr || strip_orientation != orientation;
+    }
+
+    void render_strip(const GradientSlider* slider, const QSize& size, qreal dpr,
+                      Qt::Orientation orientation)
+    {
+        strip = QImage(size * dpr, QImage::Format_ARGB32_Premultiplied);
+        strip.setDevicePixelRatio(dpr);
+        strip.fill(Qt::transparent);
+        strip_orientation = orientation;
+
+        QRectF rect(1, 1, size.width() - 2, size.height() - 2);
+        if ( rect.isEmpty() )
+            return;
+
+        // The gradient is a single line of pixels, stretched across the strip
+        int length = qMax(1, qRound((orientation == Qt::Horizontal ?
+            rect.width() : rect.height()) * dpr));
+        QImage line = slider->renderGradient(length);
+
+        QPainter painter(&strip);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(back);
+        painter.drawRect(rect);
+        if ( orientation == Qt::Vertical )
+        {
+            // Swaps x and y so the horizontal line runs top to bottom
+            painter.setTransform(QTransform(0, 1, 1, 0, 0, 0));
+            rect = QRectF(rect.y(), rect.x(), rect.height(), rect.width());
+        }
+        painter.drawImage(rect, line);
+    }
+
+    const detail::GradientKernel& get_kernel() const
+    {
+        if ( kernel_outdated )
+        {
+            kernel = detail::GradientKernel(gradient.stops(), interpolation);
+            kernel_outdated = false;
+        }
+        return kernel;
+    }
+
+    /**
+     * \brief Marks the gradient as changed
+     */
+    void invalidate()
+    {
+        kernel_outdated = true;
+        strip = QImage();
+    }
+
+    void set_stops(const QGradientStops& stops)
+    {
+        if ( stops != gradient.stops() )
+        {
+            gradient.setStops(stops);
+            invalidate();
+        }
+    }
 };
 
 GradientSlider::GradientSlider(QWidget *parent) :
@@ -75,6 +152,7 @@ QBrush GradientSlider::background() const
 void GradientSlider::setBackground(const QBrush &bg)
 {
     p->back = bg;
+    p->strip = QImage();
     update();
 }
 
@@ -85,8 +163,11 @@ QGradientStops GradientSlider::colors() const
 
 void GradientSlider::setColors(const QGradientStops &colors)
 {
-    p->gradient.setStops(colors);
-    update();
+    if ( colors != p->gradient.stops() )
+    {
+        p->set_stops(colors);
+        update();
+    }
 }
 
 QLinearGradient GradientSlider::gradient() const
@@ -97,6 +178,7 @@ QLinearGradient GradientSlider::gradient() const
 void GradientSlider::setGradient(const QLinearGradient &gradient)
 {
     p->gradient = gradient;
+    p->invalidate();
     update();
 }
 
@@ -122,10 +204,11 @@ void GradientSlider::setFirstColor(const QColor &c)
     QGradientStops stops = p->gradient.stops();
     if(stops.isEmpty())
         stops.push_back(QGradientStop(0.0, c));
+    else if(stops.front().second == c)
+        return;
     else
         stops.front().second = c;
-    p->gradient.setStops(stops);
-
+    p->set_stops(stops);
     update();
 }
 
@@ -134,9 +217,11 @@ void GradientSlider::setLastColor(const QColor &c)
     QGradientStops stops = p->gradient.stops();
     if(stops.size()<2)
         stops.push_back(QGradientStop(1.0, c));
+    else if(stops.back().second == c)
+        return;
     else
         stops.back().second = c;
-    p->gradient.setStops(stops);
+    p->set_stops(stops);
     update();
 }
 
@@ -152,6 +237,29 @@ QColor GradientSlider::lastColor() const
     return s.empty() ? QColor() : s.back().second;
 }
 
+GradientSlider::Interpolation GradientSlider::interpolation() const
+{
+    return p->interpolation;
+}
+
+void GradientSlider::setInterpolation(Interpolation interpolation)
+{
+    if ( interpolation != p->interpolation )
+    {
+        p->interpolation = interpolation;
+        p->invalidate();
+        update();
+    }
+}
+
+QColor GradientSlider::sample(qreal t) const
+{
+    const detail::GradientKernel& kernel = p->get_kernel();
+    if ( kernel.isEmpty() )
+        return QColor();
+    return QColor::fromRgba(kernel.sample(t));
+}
+
 void GradientSlider::paintEvent(QPaintEvent *)
 {
     QPainter painter(this);
@@ -165,16 +273,10 @@ void GradientSlider::paintEvent(QPaintEvent *)
     QRect r = style()->subElementRect(QStyle::SE_FrameContents, &panel, this);
     painter.setClipRect(r);
 
-    if(orientation() == Qt::Horizontal)
-        p->gradient.setFinalStop(1, 0);
-    else
-        p->gradient.setFinalStop(0, 1);
-
-    painter.setPen(Qt::NoPen);
-    painter.setBrush(p->back);
-    painter.drawRect(1,1,geometry().width()-2,geometry().height()-2);
-    painter.setBrush(p->gradient);
-    painter.drawRect(1,1,geometry().width()-2,geometry().height()-2);
+    qreal dpr = devicePixelRatioF();
+    if ( p->strip_outdated(size(), dpr, orientation()) )
+        p->render_strip(this, size(), dpr, orientation());
+    painter.drawImage(0, 0, p->strip);
 
     painter.setClipping(false);
     QStyleOptionSlider opt_slider;
@@ -188,8 +290,42 @@ void GradientSlider::paintEvent(QPaintEvent *)
     }
     opt_slider.rect = style()->subControlRect(QStyle::CC_Slider,&opt_slider,
                                               QStyle::SC_SliderHandle,this);
+    p->handle_rect = opt_slider.rect;
 
     style()->drawComplexControl(QStyle::CC_Slider, &opt_slider, &painter, this);
 }
 
+QImage GradientSlider::renderGradient(int length) const
+{
+    QImage line(length, 1, QImage::Format_ARGB32);
+    // Pixel centers, as QLinearGradient does
+    p->get_kernel().render(reinterpret_cast<QRgb*>(line.bits()), length,
+                           0.5 / length, 1.0 / length);
+    return line;
+}
+
+QRect GradientSlider::handleRect() const
+{
+    QStyleOptionSlider opt_slider;
+    initStyleOption(&opt_slider);
+    opt_slider.subControls = QStyle::SC_SliderHandle;
+    return style()->subControlRect(QStyle::CC_Slider, &opt_slider,
+                                   QStyle::SC_SliderHandle, this);
+}
+
+void GradientSlider::sliderChange(SliderChange change)
+{
+    if ( change == SliderValueChange && !p->handle_rect.isNull() )
+    {
+        // Only the handle moved, the strip below it is cached.
+        // Styles may draw shadows slightly outside of the handle rectangle.
+        const int margin = 2;
+        QRegion dirty(p->handle_rect.adjusted(-margin, -margin, margin, margin));
+        update(dirty.united(handleRect().adjusted(-margin, -margin, margin, margin)));
+        return;
+    }
+
+    QSlider::sliderChange(change);
+}
+
 } // namespace color_widgets
@@ -0,0 +1,145 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "hue_ring.hpp"
+
+#include <cmath>
+#include <QHash>
+#include <QVector>
+#include "color_utils.hpp"
+
+namespace color_widgets {
+namespace detail {
+
+namespace {
+
+struct RingKey
+{
+    qreal outer_radius;
+    qreal inner_radius;
+    qreal dpr;
+    QColor (*rainbow)(qreal);
+
+    bool operator==(const RingKey& other) const
+    {
+        return outer_radius == other.outer_radius &&
+               inner_radius == other.inner_radius &&
+               dpr == other.dpr && rainbow == other.rainbow;
+    }
+};
+
+uint qHash(const RingKey& key, uint seed = 0)
+{
+    uint hash = ::qHash(key.outer_radius, seed);
+    hash = hash * 31 + ::qHash(key.inner_radius, seed);
+    hash = hash * 31 + ::qHash(key.dpr, seed);
+    return hash * 31 + ::qHash(reinterpret_cast<quintptr>(key.rainbow), seed);
+}
+
+} // namespace
+
+QImage render_hue_ring(qreal outer_radius, qreal inner_radius,
+                       QColor (*rainbow)(qreal), qreal dpr)
+{
+    int side = qCeil(outer_radius * 2 * dpr);
+    if ( side <= 0 )
+        return QImage();
+
+    QImage image(side, side, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+
+    const double center = outer_radius * dpr;
+    const double outer = outer_radius * dpr;
+    const double inner = qMax(0.0, inner_radius * dpr);
+
+    // Hues are sampled more finely than the pixels along the outer edge
+    static const double tau = 2 * M_PI;
+    int hue_count = qBound(360, int(tau * outer) * 4, 16384);
+    QVector<QRgb> hues(hue_count);
+    for ( int i = 0; i < hue_count; i++ )
+        hues[i] = rainbow(qreal(i) / hue_count).rgb();
+    const QRgb* hue_table = hues.constData();
+    const double hue_scale = hue_count / tau;
+
+    // bits() detaches, so it's called here rather than from the workers
+    uchar* bits = image.bits();
+    const int stride = image.bytesPerLine();
+
+    parallel_for(side, [&](int begin, int end) {
+        for ( int y = begin; y < end; y++ )
+        {
+            QRgb* line = reinterpret_cast<QRgb*>(bits + y * stride);
+            // Pointing up, so angles go counterclockwise on screen
+            double dy = center - (y + 0.5);
+            for ( int x = 0; x < side; x++ )
+            {
+                double dx = x + 0.5 - center;
+                double distance = std::sqrt(dx * dx + dy * dy);
+
+                // Fraction of the pixel inside the ring, from the distance to each edge
+                double coverage = qBound(0.0, outer - distance + 0.5, 1.0) *
+                                  qBound(0.0, distance - inner + 0.5, 1.0);
+                if ( coverage <= 0 )
+                {
+                    line[x] = 0;
+                    continue;
+                }
+
+                double angle = std::atan2(dy, dx);
+                if ( angle < 0 )
+                    angle += tau;
+                QRgb rgb = hue_table[int(angle * hue_scale + 0.5) % hue_count];
+                line[x] = qPremultiply(qRgba(qRed(rgb), qGreen(rgb), qBlue(rgb),
+                                             qRound(coverage * 255)));
+            }
+        }
+    }, 16);
+
+    return image;
+}
+
+QImage hue_ring_image(qreal outer_radius, qreal inner_radius,
+                      QColor (*rainbow)(qreal), qreal dpr)
+{
+    static QHash<RingKey, QImage> cache;
+
+    // Rings no longer referenced outside of the cache are dropped
+    for ( auto it = cache.begin(); it != cache.end(); )
+    {
+        if ( it->isDetached() )
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+
+    RingKey key{outer_radius, inner_radius, dpr, rainbow};
+    auto it = cache.find(key);
+    if ( it != cache.end() )
+        return *it;
+
+    QImage ring = render_hue_ring(outer_radius, inner_radius, rainbow, dpr);
+    if ( !ring.isNull() )
+        cache.insert(key, ring);
+    return ring;
+}
+
+} // namespace detail
+} // namespace color_widgets
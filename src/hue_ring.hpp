@@ -0,0 +1,57 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_HUE_RING_HPP
+#define COLOR_WIDGETS_HUE_RING_HPP
+
+#include <QColor>
+#include <QImage>
+
+namespace color_widgets {
+namespace detail {
+
+/**
+ * \brief Renders a hue ring with antialiased edges
+ *
+ * Every pixel gets the hue of its angle, measured counterclockwise from the
+ * positive x axis like QLineF::angle().
+ *
+ * \param outer_radius Outer radius in logical pixels
+ * \param inner_radius Inner radius in logical pixels
+ * \param rainbow      Returns the color for a hue in [0-1]
+ * \param dpr          Device pixel ratio of the result
+ * \returns A square image of side 2 * \p outer_radius logical pixels
+ */
+QImage render_hue_ring(qreal outer_radius, qreal inner_radius,
+                       QColor (*rainbow)(qreal), qreal dpr);
+
+/**
+ * \brief Same as render_hue_ring() but shares the result between callers
+ *
+ * Rings are kept as long as one of the returned images is alive.
+ */
+QImage hue_ring_image(qreal outer_radius, qreal inner_radius,
+                      QColor (*rainbow)(qreal), qreal dpr);
+
+} // namespace detail
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_HUE_RING_HPP
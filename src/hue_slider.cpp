@@ -21,9 +21,81 @@
  *
  */
 #include "hue_slider.hpp"
+#include "cached_color.hpp"
+
+#include <QHash>
+#include <QPair>
 
 namespace color_widgets {
 
+namespace {
+
+/// Number of rainbow lines kept in rainbow_line()
+const int max_rainbow_lines = 8;
+
+/**
+ * \brief Fully saturated hues for each pixel center of a line of \p length pixels
+ */
+QImage rainbow_line(int length)
+{
+    static QHash<int, QImage> cache;
+    auto it = cache.find(length);
+    if ( it != cache.end() )
+        return *it;
+
+    QImage line(length, 1, QImage::Format_ARGB32);
+    QRgb* pixels = reinterpret_cast<QRgb*>(line.bits());
+    for ( int i = 0; i < length; i++ )
+        pixels[i] = QColor::fromHsvF((i + 0.5) / length, 1, 1).rgb();
+
+    if ( cache.size() >= max_rainbow_lines )
+        cache.clear();
+    cache.insert(length, line);
+    return line;
+}
+
+/**
+ * \brief Hue line with the given HSV saturation and value, shared between sliders
+ *
+ * Lines are kept as long as one of the returned images is alive.
+ */
+QImage hue_line(qreal saturation, qreal value, int length)
+{
+    typedef QPair<QPair<qreal, qreal>, int> Key;
+    static QHash<Key, QImage> cache;
+
+    for ( auto it = cache.begin(); it != cache.end(); )
+    {
+        if ( it->isDetached() )
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+
+    Key key(qMakePair(saturation, value), length);
+    auto it = cache.find(key);
+    if ( it != cache.end() )
+        return *it;
+
+    // For a given hue each RGB component is v * (1 - s + s * pure),
+    // where pure is the component at full saturation and value
+    int tint[256];
+    for ( int c = 0; c < 256; c++ )
+        tint[c] = qRound(255 * value * (1 - saturation + saturation * c / 255.0));
+
+    QImage rainbow = rainbow_line(length);
+    const QRgb* pure = reinterpret_cast<const QRgb*>(rainbow.constBits());
+    QImage line(length, 1, QImage::Format_ARGB32);
+    QRgb* pixels = reinterpret_cast<QRgb*>(line.bits());
+    for ( int i = 0; i < length; i++ )
+        pixels[i] = qRgb(tint[qRed(pure[i])], tint[qGreen(pure[i])], tint[qBlue(pure[i])]);
+
+    cache.insert(key, line);
+    return line;
+}
+
+} // namespace
+
 class HueSlider::Private
 {
 private:
@@ -33,6 +105,8 @@ public:
     qreal saturation = 1;
     qreal value = 1;
     qreal alpha = 1;
+    /// Keeps the line shared by hue_line() alive
+    QImage line;
 
     Private(HueSlider *widget)
         : w(widget)
@@ -44,6 +118,11 @@ public:
         updateGradient();
     }
 
+    /**
+     * \brief Updates the stops, which also makes renderGradient() be called again
+     *
+     * The stops aren't drawn but keep colors(), sample() and ColorMap in sync.
+     */
     void updateGradient()
     {
         static const double n_colors = 6;
@@ -82,8 +161,12 @@ qreal HueSlider::colorSaturation() const
 
 void HueSlider::setColorSaturation(qreal s)
 {
-    p->saturation = qBound(0.0, s, 1.0);
-    p->updateGradient();
+    s = qBound(0.0, s, 1.0);
+    if ( s != p->saturation )
+    {
+        p->saturation = s;
+        p->updateGradient();
+    }
 }
 
 qreal HueSlider::colorValue() const
@@ -93,8 +176,12 @@ qreal HueSlider::colorValue() const
 
 void HueSlider::setColorValue(qreal v)
 {
-    p->value = qBound(0.0, v, 1.0);
-    p->updateGradient();
+    v = qBound(0.0, v, 1.0);
+    if ( v != p->value )
+    {
+        p->value = v;
+        p->updateGradient();
+    }
 }
 
 qreal HueSlider::colorAlpha() const
@@ -104,8 +191,8 @@ qreal HueSlider::colorAlpha() const
 
 void HueSlider::setColorAlpha(qreal alpha)
 {
+    // The gradient is always opaque
     p->alpha = alpha;
-    p->updateGradient();
 }
 
 QColor HueSlider::color() const
@@ -115,10 +202,14 @@ QColor HueSlider::color() const
 
 void HueSlider::setColor(const QColor& color)
 {
-    p->saturation = color.saturationF();
-    p->value = color.valueF();
-    p->updateGradient();
-    setColorHue(color.hueF());
+    CachedColor cached(color);
+    if ( cached.hsvSaturationF() != p->saturation || cached.valueF() != p->value )
+    {
+        p->saturation = cached.hsvSaturationF();
+        p->value = cached.valueF();
+        p->updateGradient();
+    }
+    setColorHue(cached.hsvHueF());
 }
 
 void HueSlider::setFullColor(const QColor& color)
@@ -137,4 +228,10 @@ void HueSlider::setColorHue(qreal colorHue)
     setValue(minimum()+colorHue*(maximum()-minimum()));
 }
 
+QImage HueSlider::renderGradient(int length) const
+{
+    p->line = hue_line(p->saturation, p->value, length);
+    return p->line;
+}
+
 } // namespace color_widgets
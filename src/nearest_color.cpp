@@ -0,0 +1,135 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "nearest_color.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace color_widgets {
+namespace detail {
+
+void NearestColorIndex::build(const QVector<QRgb>& colors)
+{
+    nodes.clear();
+    nodes.reserve(colors.size());
+    for ( int i = 0; i < colors.size(); i++ )
+    {
+        Oklab lab = rgb_to_oklab(colors[i]);
+        nodes.push_back(Node{{lab.l, lab.a, lab.b}, i, 0});
+    }
+    build(0, nodes.size());
+}
+
+void NearestColorIndex::clear()
+{
+    nodes.clear();
+}
+
+void NearestColorIndex::build(int begin, int end)
+{
+    if ( end - begin < 2 )
+        return;
+
+    // Split along the axis with the largest extent
+    float min[3], max[3];
+    for ( int c = 0; c < 3; c++ )
+        min[c] = max[c] = nodes[begin].pos[c];
+    for ( int i = begin + 1; i < end; i++ )
+    {
+        for ( int c = 0; c < 3; c++ )
+        {
+            min[c] = qMin(min[c], nodes[i].pos[c]);
+            max[c] = qMax(max[c], nodes[i].pos[c]);
+        }
+    }
+    int axis = 0;
+    for ( int c = 1; c < 3; c++ )
+        if ( max[c] - min[c] > max[axis] - min[axis] )
+            axis = c;
+
+    int mid = begin + (end - begin) / 2;
+    Node* data = nodes.data();
+    std::nth_element(data + begin, data + mid, data + end,
+        [axis](const Node& a, const Node& b) {
+            return a.pos[axis] < b.pos[axis];
+        });
+    data[mid].axis = axis;
+
+    build(begin, mid);
+    build(mid + 1, end);
+}
+
+int NearestColorIndex::nearest(const Oklab& lab, float* distance) const
+{
+    int best = -1;
+    float best_distance = std::numeric_limits<float>::max();
+    const float pos[3] = {lab.l, lab.a, lab.b};
+    search(0, nodes.size(), pos, best, best_distance);
+
+    if ( distance )
+        *distance = best == -1 ? 0 : std::sqrt(best_distance);
+    return best == -1 ? -1 : nodes[best].index;
+}
+
+void NearestColorIndex::search(int begin, int end, const float* pos,
+                               int& best, float& best_distance) const
+{
+    if ( begin >= end )
+        return;
+
+    int mid = begin + (end - begin) / 2;
+    const Node& node = nodes[mid];
+
+    float d0 = node.pos[0] - pos[0];
+    float d1 = node.pos[1] - pos[1];
+    float d2 = node.pos[2] - pos[2];
+    float distance = d0 * d0 + d1 * d1 + d2 * d2;
+    if ( distance < best_distance ||
+         ( distance == best_distance && best != -1 && node.index < nodes[best].index ) )
+    {
+        best = mid;
+        best_distance = distance;
+    }
+
+    if ( end - begin == 1 )
+        return;
+
+    float delta = pos[node.axis] - node.pos[node.axis];
+    bool left_first = delta < 0;
+    if ( left_first )
+        search(begin, mid, pos, best, best_distance);
+    else
+        search(mid + 1, end, pos, best, best_distance);
+
+    // <= so equally distant colors on the other side can win the tie
+    if ( delta * delta <= best_distance )
+    {
+        if ( left_first )
+            search(mid + 1, end, pos, best, best_distance);
+        else
+            search(begin, mid, pos, best, best_distance);
+    }
+}
+
+} // namespace detail
+} // namespace color_widgets
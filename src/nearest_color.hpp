@@ -0,0 +1,84 @@
+/**
+ * \file
+ *
+ * \author Mattia Basaglia
+ *
+ * \copyright Copyright (C) 2013-2017 Mattia Basaglia
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef COLOR_WIDGETS_NEAREST_COLOR_HPP
+#define COLOR_WIDGETS_NEAREST_COLOR_HPP
+
+#include <QColor>
+#include <QVector>
+#include "color_utils.hpp"
+
+namespace color_widgets {
+namespace detail {
+
+/**
+ * \brief K-d tree answering nearest color queries in OKLab
+ *
+ * Ties are resolved in favour of the lowest index.
+ */
+class NearestColorIndex
+{
+public:
+    NearestColorIndex() = default;
+
+    /**
+     * \brief Rebuilds the tree from a list of colors, alpha is ignored
+     */
+    void build(const QVector<QRgb>& colors);
+
+    /**
+     * \brief Removes all the colors
+     */
+    void clear();
+
+    bool empty() const { return nodes.empty(); }
+
+    /**
+     * \brief Index of the color closest to \p lab
+     * \param distance If not null, set to the OKLab euclidean distance
+     * \returns -1 if the tree is empty
+     */
+    int nearest(const Oklab& lab, float* distance = nullptr) const;
+
+    int nearest(QRgb rgb, float* distance = nullptr) const
+    {
+        return nearest(rgb_to_oklab(rgb), distance);
+    }
+
+private:
+    struct Node
+    {
+        float pos[3];
+        int   index;    ///< Index in the original list
+        int   axis;     ///< Splitting axis
+    };
+
+    void build(int begin, int end);
+    void search(int begin, int end, const float* pos,
+                int& best, float& best_distance) const;
+
+    QVector<Node> nodes;
+};
+
+} // namespace detail
+} // namespace color_widgets
+
+#endif // COLOR_WIDGETS_NEAREST_COLOR_HPP
@@ -33,6 +33,8 @@
 #include <QStyleOption>
 #include <QToolTip>
 
+#include "color_utils.hpp"
+
 namespace color_widgets {
 
 class Swatch::Private
@@ -752,6 +754,9 @@ bool Swatch::event(QEvent* event)
             QString message = color.name();
             if ( !name.isEmpty() )
                 message = tr("%1 (%2)").arg(name).arg(message);
+            // Separate string so translations of the one above keep working
+            message = tr("%1, %2", "Color tooltip, nearest color name")
+                .arg(message).arg(detail::color_name_hint(color));
             message = "<tt style='background-color:"+color.name()+";color:"+color.name()+";'>MM</tt> "+message.toHtmlEscaped();
             QToolTip::showText(help_ev->globalPos(), message, this,
                                p->indexRect(index).toRect());
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2013-2017 Mattia Basaglia
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+################################################################################
+# Generates name_seeds and name_slots in src/color_names.cpp                   #
+# Reads the names from named_colors and prints the two tables, which replace   #
+# the ones in the source file whenever named_colors changes                    #
+# Usage: tools/color_name_hash.py [src/color_names.cpp]                        #
+################################################################################
+
+import os
+import re
+import sys
+
+SEED_COUNT = 64
+SLOT_COUNT = 256
+
+
+def name_hash(name, seed):
+    """FNV-1a, matches name_hash() in color_names.cpp"""
+    value = 2166136261 ^ seed
+    for c in name.encode("ascii"):
+        value ^= c
+        value = (value * 16777619) & 0xffffffff
+    return value
+
+
+def read_names(path):
+    with open(path) as source:
+        text = source.read()
+    table = re.search(r"named_colors\[\] = \{(.*?)\n\};", text, re.S)
+    if not table:
+        sys.exit("named_colors not found in %s" % path)
+    return re.findall(r'\{"([a-z]+)",', table.group(1))
+
+
+def search(names):
+    buckets = [[] for i in range(SEED_COUNT)]
+    for index, name in enumerate(names):
+        buckets[name_hash(name, 0) % SEED_COUNT].append(index)
+
+    seeds = [0] * SEED_COUNT
+    slots = [0] * SLOT_COUNT
+    # Larger buckets first, they are the hardest to place
+    order = sorted(range(SEED_COUNT), key=lambda b: -len(buckets[b]))
+    for bucket in order:
+        if not buckets[bucket]:
+            break
+        for seed in range(256):
+            taken = [name_hash(names[i], seed) % SLOT_COUNT for i in buckets[bucket]]
+            if len(set(taken)) == len(taken) and not any(slots[s] for s in taken):
+                break
+        else:
+            sys.exit("No seed found, try a larger SLOT_COUNT")
+        seeds[bucket] = seed
+        for index, slot in zip(buckets[bucket], taken):
+            slots[slot] = index + 1
+    return seeds, slots
+
+
+def print_table(name, values):
+    print("const quint8 %s[%s] = {" % (name, len(values)))
+    for row in range(0, len(values), 16):
+        print("   " + ",".join("%4d" % v for v in values[row:row+16]) + ",")
+    print("};")
+
+
+if __name__ == "__main__":
+    default = os.path.join(os.path.dirname(__file__), "..", "src", "color_names.cpp")
+    names = read_names(sys.argv[1] if len(sys.argv) > 1 else default)
+    if len(names) >= 256:
+        sys.exit("Too many names for quint8 slots")
+    seeds, slots = search(names)
+    print_table("name_seeds", seeds)
+    print()
+    print_table("name_slots", slots)